@@ -4,10 +4,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-#include <stdio.h>
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 
+#include "led_pattern.h"
+
 /* 1000 msec = 1 sec */
 #define SLEEP_TIME_MS   2000
 
@@ -21,82 +22,46 @@
  * A build error on this line means your board is unsupported.
  * See the sample documentation for information on how to fix this.
  */
-static const struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET(LED0_NODE, gpios);
-static const struct gpio_dt_spec led2 = GPIO_DT_SPEC_GET(LED1_NODE, gpios);
-static const struct gpio_dt_spec led3 = GPIO_DT_SPEC_GET(LED2_NODE, gpios);
-static const struct gpio_dt_spec led4 = GPIO_DT_SPEC_GET(LED3_NODE, gpios);
+static const struct gpio_dt_spec leds[] = {
+	GPIO_DT_SPEC_GET(LED0_NODE, gpios),
+	GPIO_DT_SPEC_GET(LED1_NODE, gpios),
+	GPIO_DT_SPEC_GET(LED2_NODE, gpios),
+	GPIO_DT_SPEC_GET(LED3_NODE, gpios),
+};
+
+#define LED1	BIT(0)
+#define LED2	BIT(1)
+#define LED3	BIT(2)
+#define LED4	BIT(3)
+#define LED_ALL	(LED1 | LED2 | LED3 | LED4)
+
+/* LED1..LED3 on, LED4 off */
+static const struct led_step start_step = LED_STEP_SET(LED_ALL, LED1 | LED2 | LED3, 0);
+
+/* Each step toggles its LEDs together, in one write per GPIO port */
+static const struct led_step pattern[] = {
+	LED_STEP_TOGGLE(LED_ALL, SLEEP_TIME_MS),
+	LED_STEP_TOGGLE(LED1, SLEEP_TIME_MS),
+	LED_STEP_TOGGLE(LED1 | LED2, SLEEP_TIME_MS),
+	LED_STEP_TOGGLE(LED2 | LED3, SLEEP_TIME_MS),
+	LED_STEP_TOGGLE(LED3 | LED4, SLEEP_TIME_MS),
+	LED_STEP_TOGGLE(LED4, SLEEP_TIME_MS),
+};
+
+static struct led_group group;
+static struct led_player player;
 
 int main(void)
 {
-	int ret1, ret2, ret3, ret4;
-	bool led_state = true;
-
-	if (!gpio_is_ready_dt(&led1)) {
-		return 0;
-	}
-
-	if (!gpio_is_ready_dt(&led2)) {
-                return 0;
-        }
-
-	
-	if (!gpio_is_ready_dt(&led3)) {
-                return 0;
-        }
-
-	if (!gpio_is_ready_dt(&led4)){
+	if (led_group_init(&group, leds, ARRAY_SIZE(leds)) < 0) {
 		return 0;
 	}
 
-	ret1 = gpio_pin_configure_dt(&led1, GPIO_OUTPUT_ACTIVE);
-	ret2 = gpio_pin_configure_dt(&led2, GPIO_OUTPUT_ACTIVE);
-	ret3 = gpio_pin_configure_dt(&led3, GPIO_OUTPUT_ACTIVE);
-	ret4 = gpio_pin_configure_dt(&led4, GPIO_OUTPUT_ACTIVE);
-	if (ret1<0 || ret2<0 )
-	{
+	if (led_group_apply(&group, &start_step) < 0) {
 		return 0;
 	}
 
-	ret4 = gpio_pin_toggle_dt(&led4);
-	while (1) {
-		/*All off*/
-		ret1 = gpio_pin_toggle_dt(&led1);
-		ret2 = gpio_pin_toggle_dt(&led2);
-		ret3 = gpio_pin_toggle_dt(&led3);
-		ret4 = gpio_pin_toggle_dt(&led4);
-		if (ret1<0 || ret2<0 || ret3<0 || ret4<0) {
-			return 0;
-		}
-
-		led_state = !led_state;
-		printf("LED state: %s\n", led_state ? "ON" : "OFF");
-	
-		led_state = !led_state;
-		k_msleep(SLEEP_TIME_MS);
-
-		/*
-		ret4 = gpio_pin_toggle_dt(&led4);
-		k_msleep(SLEEP_TIME_MS);*/
-
-		//ret4 = gpio_pin_toggle_dt(&led4);
-		
-		ret1 = gpio_pin_toggle_dt(&led1);
-		k_msleep(SLEEP_TIME_MS);
-
-		ret1 = gpio_pin_toggle_dt(&led1);
-		ret2 = gpio_pin_toggle_dt(&led2);
-		k_msleep(SLEEP_TIME_MS);
-
-		ret2 = gpio_pin_toggle_dt(&led2);
-		ret3 = gpio_pin_toggle_dt(&led3);
-		k_msleep(SLEEP_TIME_MS);
-
-		ret3 = gpio_pin_toggle_dt(&led3);
-		ret4 = gpio_pin_toggle_dt(&led4);
-		k_msleep(SLEEP_TIME_MS);
-
-		ret4 = gpio_pin_toggle_dt(&led4);
-		k_msleep(SLEEP_TIME_MS);
-	}
+	/* Steps run from timer expiries, main has nothing left to do */
+	led_player_start(&player, &group, pattern, ARRAY_SIZE(pattern));
 	return 0;
 }
@@ -0,0 +1,57 @@
+/*Timed GPIO action engine
+ * Any number of periodic or one-shot LED actions are kept in a min-heap
+ * ordered by deadline and run from a single delayable work item, so no
+ * thread or stack is needed per LED.*/
+
+#ifndef LED_SCHED_H
+#define LED_SCHED_H
+
+#include <zephyr/kernel.h>
+#include<zephyr/drivers/gpio.h>
+
+#include "led_pattern.h"
+
+enum led_op {
+	LED_OP_TOGGLE,
+	LED_OP_ON,
+	LED_OP_OFF,
+	/*Apply a port-batched led_step to a led_group*/
+	LED_OP_STEP,
+};
+
+struct led_action {
+	const struct gpio_dt_spec *led;
+	enum led_op op;
+	/*Used by LED_OP_STEP instead of led*/
+	const struct led_group *group;
+	const struct led_step *step;
+	/*Repeat period, 0 for a one-shot action*/
+	uint32_t period_ms;
+	/*Sequencing: next is started next_delay_ms after this action runs*/
+	struct led_action *next;
+	uint32_t next_delay_ms;
+
+	/*Private, owned by the scheduler*/
+	int64_t due;
+	int16_t heap_idx;
+};
+
+#define LED_ACTION_PERIODIC(_led, _op, _period_ms) \
+	{ .led = (_led), .op = (_op), .period_ms = (_period_ms), .heap_idx = -1 }
+
+#define LED_ACTION_STEP(_led, _op, _next, _next_delay_ms) \
+	{ .led = (_led), .op = (_op), .next = (_next), \
+	  .next_delay_ms = (_next_delay_ms), .heap_idx = -1 }
+
+#define LED_ACTION_GROUP_STEP(_group, _step, _next, _next_delay_ms) \
+	{ .op = LED_OP_STEP, .group = (_group), .step = (_step), .next = (_next), \
+	  .next_delay_ms = (_next_delay_ms), .heap_idx = -1 }
+
+/*Schedule an action phase_ms from now, returns -ENOMEM when the heap is full
+ * and -EALREADY if the action is already scheduled*/
+int led_sched_add(struct led_action *action, uint32_t phase_ms);
+
+/*Remove a pending action, returns -ENOENT if it was not scheduled*/
+int led_sched_cancel(struct led_action *action);
+
+#endif
@@ -0,0 +1,188 @@
+/*Timed GPIO action engine
+ * Deadlines are absolute tick counts, periodic actions are advanced from
+ * their previous deadline so they never drift, and the work item is always
+ * rescheduled for the earliest pending deadline.*/
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include<zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+
+#include "led_sched.h"
+
+LOG_MODULE_REGISTER(led_sched);
+
+#define MAX_ACTIONS CONFIG_APP_LED_SCHED_MAX_ACTIONS
+
+static struct led_action *heap[MAX_ACTIONS];
+static int heap_len;
+static struct k_spinlock sched_lock;
+
+static void led_sched_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(sched_work, led_sched_work_handler);
+
+static void heap_set(int idx, struct led_action *a)
+{
+	heap[idx] = a;
+	a->heap_idx = idx;
+}
+
+static void heap_sift_up(int idx)
+{
+	struct led_action *a = heap[idx];
+
+	while(idx > 0){
+		int parent = (idx - 1) / 2;
+
+		if(heap[parent]->due <= a->due){
+			break;
+		}
+		heap_set(idx, heap[parent]);
+		idx = parent;
+	}
+	heap_set(idx, a);
+}
+
+static void heap_sift_down(int idx)
+{
+	struct led_action *a = heap[idx];
+
+	while(1){
+		int child = 2 * idx + 1;
+
+		if(child >= heap_len){
+			break;
+		}
+		if(child + 1 < heap_len && heap[child + 1]->due < heap[child]->due){
+			child++;
+		}
+		if(a->due <= heap[child]->due){
+			break;
+		}
+		heap_set(idx, heap[child]);
+		idx = child;
+	}
+	heap_set(idx, a);
+}
+
+static int heap_push(struct led_action *a)
+{
+	if(heap_len == MAX_ACTIONS){
+		return -ENOMEM;
+	}
+	heap_set(heap_len++, a);
+	heap_sift_up(a->heap_idx);
+	return 0;
+}
+
+static void heap_remove(struct led_action *a)
+{
+	int idx = a->heap_idx;
+	struct led_action *last = heap[--heap_len];
+
+	a->heap_idx = -1;
+	if(idx == heap_len){
+		return;
+	}
+	heap_set(idx, last);
+	heap_sift_up(idx);
+	heap_sift_down(last->heap_idx);
+}
+
+/*Called with sched_lock held after the heap top may have changed*/
+static void sched_rearm(void)
+{
+	if(heap_len == 0){
+		k_work_cancel_delayable(&sched_work);
+		return;
+	}
+	k_work_reschedule(&sched_work, K_TIMEOUT_ABS_TICKS(heap[0]->due));
+}
+
+static void led_run(const struct led_action *a)
+{
+	switch(a->op){
+	case LED_OP_TOGGLE:
+		gpio_pin_toggle_dt(a->led);
+		break;
+	case LED_OP_ON:
+		gpio_pin_set_dt(a->led, 1);
+		break;
+	case LED_OP_OFF:
+		gpio_pin_set_dt(a->led, 0);
+		break;
+	case LED_OP_STEP:
+		led_group_apply(a->group, a->step);
+		break;
+	}
+}
+
+static void led_sched_work_handler(struct k_work *work)
+{
+	int64_t now = k_uptime_ticks();
+
+	while(1){
+		k_spinlock_key_t key = k_spin_lock(&sched_lock);
+		struct led_action *a = heap_len ? heap[0] : NULL;
+
+		if(a == NULL || a->due > now){
+			sched_rearm();
+			k_spin_unlock(&sched_lock, key);
+			break;
+		}
+
+		int64_t fired = a->due;
+		int chain_err = 0;
+
+		heap_remove(a);
+		if(a->period_ms){
+			/*Keep the phase, skip periods missed while the queue was busy*/
+			do {
+				a->due += k_ms_to_ticks_ceil64(a->period_ms);
+			} while(a->due <= now);
+			heap_push(a);
+		}
+		if(a->next != NULL && a->next->heap_idx < 0){
+			a->next->due = fired + k_ms_to_ticks_ceil64(a->next_delay_ms);
+			chain_err = heap_push(a->next);
+		}
+		k_spin_unlock(&sched_lock, key);
+
+		if(chain_err < 0){
+			LOG_WRN("Chained action dropped, all %d slots in use", MAX_ACTIONS);
+		}
+
+		led_run(a);
+	}
+}
+
+int led_sched_add(struct led_action *action, uint32_t phase_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&sched_lock);
+	int ret = -EALREADY;
+
+	if(action->heap_idx < 0){
+		action->due = k_uptime_ticks() + k_ms_to_ticks_ceil64(phase_ms);
+		ret = heap_push(action);
+		if(ret == 0 && action->heap_idx == 0){
+			sched_rearm();
+		}
+	}
+	k_spin_unlock(&sched_lock, key);
+	return ret;
+}
+
+int led_sched_cancel(struct led_action *action)
+{
+	k_spinlock_key_t key = k_spin_lock(&sched_lock);
+	int ret = -ENOENT;
+
+	if(action->heap_idx >= 0){
+		heap_remove(action);
+		sched_rearm();
+		ret = 0;
+	}
+	k_spin_unlock(&sched_lock, key);
+	return ret;
+}
@@ -16,77 +16,53 @@
 #define LED3_NODE DT_ALIAS(led2)
 #define LED4_NODE DT_ALIAS(led3)
 
-#define STACK_SIZE 512
-#define PRIORITY 5
-
 //#include "led_threads.h"
+#include "led_sched.h"
 
 LOG_MODULE_REGISTER(main);
 
-static const struct gpio_dt_spec led1=GPIO_DT_SPEC_GET(LED1_NODE, gpios);
-static const struct gpio_dt_spec led2=GPIO_DT_SPEC_GET(LED2_NODE, gpios);
-static const struct gpio_dt_spec led3=GPIO_DT_SPEC_GET(LED3_NODE, gpios);
-static const struct gpio_dt_spec led4=GPIO_DT_SPEC_GET(LED4_NODE, gpios);
-
-K_SEM_DEFINE(sem1, 1, 1);
-K_SEM_DEFINE(sem2, 0, 1);
-K_SEM_DEFINE(sem3, 0, 1);
-K_SEM_DEFINE(sem4, 0, 1);
-
-void led1_thread(void *a, void *b, void *c){
-        while(1){
-		k_sem_take(&sem1, K_FOREVER);
-                gpio_pin_toggle_dt(&led1);
-                k_msleep(SLEEP_MS1);
-		k_sem_give(&sem2);
-        }
-}
+static const struct gpio_dt_spec leds[] = {
+	GPIO_DT_SPEC_GET(LED1_NODE, gpios),
+	GPIO_DT_SPEC_GET(LED2_NODE, gpios),
+	GPIO_DT_SPEC_GET(LED3_NODE, gpios),
+	GPIO_DT_SPEC_GET(LED4_NODE, gpios),
+};
 
-void led2_thread(void *a, void *b, void *c){
-        while(1){
-		k_sem_take(&sem2, K_FOREVER);
-                gpio_pin_toggle_dt(&led2);
-                k_msleep(SLEEP_MS2);
-		k_sem_give(&sem3);
-        }
-}
+static struct led_group group;
 
-void led3_thread(void *a, void *b, void *c){
-        while(1){
-		k_sem_take(&sem3, K_FOREVER);
-                gpio_pin_toggle_dt(&led3);
-                k_msleep(SLEEP_MS3);
-		k_sem_give(&sem4);
-        }
-}
+/*LED1..LED3 on, LED4 off, in one write per GPIO port*/
+static const struct led_step start_step = LED_STEP_SET(0xF, 0x7, 0);
 
-void led4_thread(void *a, void *b, void *c){
-        while(1){
-		k_sem_take(&sem4, K_FOREVER);
-                gpio_pin_toggle_dt(&led4);
-                k_msleep(SLEEP_MS4);
-		k_sem_give(&sem1);
-        }
-}
+static const struct led_step toggle_steps[] = {
+	LED_STEP_TOGGLE(BIT(0), 0),
+	LED_STEP_TOGGLE(BIT(1), 0),
+	LED_STEP_TOGGLE(BIT(2), 0),
+	LED_STEP_TOGGLE(BIT(3), 0),
+};
 
-K_THREAD_DEFINE(led1_id, STACK_SIZE, led1_thread, NULL, NULL, NULL, PRIORITY, 0, 0);
-K_THREAD_DEFINE(led2_id, STACK_SIZE, led2_thread, NULL, NULL, NULL, PRIORITY, 0, 0);
-K_THREAD_DEFINE(led3_id, STACK_SIZE, led3_thread, NULL, NULL, NULL, PRIORITY, 0, 0);
-K_THREAD_DEFINE(led4_id, STACK_SIZE, led4_thread, NULL, NULL, NULL, PRIORITY, 0, 0);
+/*Each LED toggles, then hands over to the next one after its delay*/
+static struct led_action step1, step2, step3, step4;
+
+static struct led_action step1 = LED_ACTION_GROUP_STEP(&group, &toggle_steps[0], &step2, SLEEP_MS1);
+static struct led_action step2 = LED_ACTION_GROUP_STEP(&group, &toggle_steps[1], &step3, SLEEP_MS2);
+static struct led_action step3 = LED_ACTION_GROUP_STEP(&group, &toggle_steps[2], &step4, SLEEP_MS3);
+static struct led_action step4 = LED_ACTION_GROUP_STEP(&group, &toggle_steps[3], &step1, SLEEP_MS4);
 
 int main(){
-	LOG_INF("LED threads started");
-	if(!device_is_ready(led1.port) || !device_is_ready(led2.port) || !device_is_ready(led3.port) || !device_is_ready(led4.port)){
+	if(led_group_init(&group, leds, ARRAY_SIZE(leds)) != 0){
 		LOG_ERR("One or more leds not ready");
 		return -1;
 	}
 
-	gpio_pin_configure_dt(&led1, GPIO_OUTPUT_ACTIVE);
-	gpio_pin_configure_dt(&led2, GPIO_OUTPUT_ACTIVE);
-	gpio_pin_configure_dt(&led3, GPIO_OUTPUT_ACTIVE);
-	gpio_pin_configure_dt(&led4, GPIO_OUTPUT);
+	led_group_apply(&group, &start_step);
+
+	LOG_INF("LEDs configured");
 
-	LOG_INF("Thread: LEDs configured");
+	if(led_sched_add(&step1, 0) != 0){
+		LOG_ERR("LED sequence not scheduled");
+		return -1;
+	}
+	LOG_INF("LED sequence started");
 
 	return 0;
 }
@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# SPDX-License-Identifier: Apache-2.0
+#
+# Build bluetooth/peripheral and bluetooth/central_bench for nrf52_bsim and run
+# them against each other in BabbleSim. The script exits with the central's
+# verdict, so it can gate CI on throughput / latency regressions.
+#
+# Requires ZEPHYR_BASE, BSIM_OUT_PATH and BSIM_COMPONENTS_PATH (see the Zephyr
+# BabbleSim documentation). Extra arguments are passed to both west builds,
+# e.g. ./run_bsim.sh -- -DCONFIG_BENCH_MIN_KBPS_2M=800
+
+set -eu
+
+: "${ZEPHYR_BASE:?ZEPHYR_BASE must be set}"
+: "${BSIM_OUT_PATH:?BSIM_OUT_PATH must be set}"
+
+BOARD=nrf52_bsim
+SIM_ID=${SIM_ID:-custom_gatt_bench}
+SIM_LENGTH_US=${SIM_LENGTH_US:-120e6}
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+PERIPHERAL_DIR="${SCRIPT_DIR}/../peripheral"
+BUILD_DIR=${BUILD_DIR:-"${SCRIPT_DIR}/build_bsim"}
+
+west build -p auto -b "${BOARD}" -d "${BUILD_DIR}/peripheral" "${PERIPHERAL_DIR}" "$@"
+west build -p auto -b "${BOARD}" -d "${BUILD_DIR}/central" "${SCRIPT_DIR}" "$@"
+
+cd "${BSIM_OUT_PATH}/bin"
+
+"${BUILD_DIR}/peripheral/zephyr/zephyr.exe" -s="${SIM_ID}" -d=0 -rs=23 &
+"${BUILD_DIR}/central/zephyr/zephyr.exe" -s="${SIM_ID}" -d=1 -rs=6 &
+central_pid=$!
+
+./bs_2G4_phy_v1 -s="${SIM_ID}" -D=2 -sim_length="${SIM_LENGTH_US}" &
+phy_pid=$!
+
+status=0
+wait "${central_pid}" || status=$?
+wait "${phy_pid}" || true
+
+if [ "${status}" -ne 0 ]; then
+	echo "Custom GATT service benchmark FAILED (exit ${status})"
+else
+	echo "Custom GATT service benchmark PASSED"
+fi
+exit "${status}"
@@ -0,0 +1,604 @@
+/*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Description: Scripted central for the custom GATT service benchmark
+* The central scans for the custom peripheral (bluetooth/peripheral) by name,
+* connects, exchanges MTU, discovers Char1/Char2 and subscribes to Char1
+* notifications. For every PHY and payload size in the test matrix it measures
+* 1. Notification throughput: a burst requested over Char2
+* 2. Echo latency: write without response to notification round trip
+* 3. Write round-trip time: Write Request to Write Response
+* The echo and the write are sized from the case payload like the burst.
+* Results are printed as a table and checked against the Kconfig regression
+* thresholds. On nrf52_bsim the process exit code reports the verdict, see
+* run_bsim.sh.
+*
+* Author: Stuti Dave
+* */
+
+ /** @file
+ *  @brief Custom GATT Service benchmark central
+ */
+
+
+//////////////////////////////////////////////////////////////////////////////////
+// Includes
+//////////////////////////////////////////////////////////////////////////////////
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/logging/log.h>
+
+#if defined(CONFIG_ARCH_POSIX)
+#include <nsi_main.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////
+// Logging
+//////////////////////////////////////////////////////////////////////////////////
+
+LOG_MODULE_REGISTER(central_bench);
+
+//////////////////////////////////////////////////////////////////////////////////
+// Private defines and macros
+//////////////////////////////////////////////////////////////////////////////////
+
+/* Service and characteristic UUIDs, must match bluetooth/peripheral */
+#define BT_UUID_CUSTOM_CHAR1_VAL BT_UUID_128_ENCODE(0x3f8e27a1, 0xb5b2, 0x46ea, 0x8d8a, 0x7f3a41a6c9e3)
+#define BT_UUID_CUSTOM_CHAR1 BT_UUID_DECLARE_128(BT_UUID_CUSTOM_CHAR1_VAL)
+
+#define BT_UUID_CUSTOM_CHAR2_VAL BT_UUID_128_ENCODE(0xf24a6e4c, 0x92cb, 0x40d0, 0xb7f6, 0xcc5d48cb5b7a)
+#define BT_UUID_CUSTOM_CHAR2 BT_UUID_DECLARE_128(BT_UUID_CUSTOM_CHAR2_VAL)
+
+/* Char2 single-segment header and benchmark opcodes, must match bluetooth/peripheral */
+#define CHAR2_SEG_SINGLE 0x03
+#define CGS_OP_BENCH_NOTIFY 0xB1
+#define CGS_OP_ECHO 0xB2
+
+/* Payload sizes of the matrix: default ATT MTU (23) and the largest negotiated MTU (247) */
+#define PAYLOAD_DEFAULT_MTU 20
+#define PAYLOAD_MAX_MTU (CONFIG_BT_L2CAP_TX_MTU - 3)
+
+#define STEP_TIMEOUT K_SECONDS(10)
+
+//////////////////////////////////////////////////////////////////////////////////
+// Structures and Global Variables
+/////////////////////////////////////////////////////////////////////////////////
+
+/* One entry of the PHY / MTU test matrix */
+struct bench_case {
+        const char *phy_name;
+        uint8_t phy;
+        uint16_t payload_len;
+        uint32_t min_kbps;
+};
+
+static const struct bench_case bench_cases[] = {
+        { "1M", BT_GAP_LE_PHY_1M, PAYLOAD_DEFAULT_MTU, 0 },
+        { "1M", BT_GAP_LE_PHY_1M, PAYLOAD_MAX_MTU, CONFIG_BENCH_MIN_KBPS_1M },
+        { "2M", BT_GAP_LE_PHY_2M, PAYLOAD_DEFAULT_MTU, 0 },
+        { "2M", BT_GAP_LE_PHY_2M, PAYLOAD_MAX_MTU, CONFIG_BENCH_MIN_KBPS_2M },
+};
+
+/* Latency statistics in microseconds */
+struct lat_stats {
+        uint32_t min_us;
+        uint32_t max_us;
+        uint64_t sum_us;
+        uint32_t count;
+};
+
+struct bench_result {
+        uint32_t kbps;
+        uint32_t rx_count;
+        struct lat_stats echo;
+        struct lat_stats write;
+};
+
+static struct bench_result results[ARRAY_SIZE(bench_cases)];
+
+/* What incoming Char1 notifications are currently accounted to */
+enum bench_mode {
+        BENCH_MODE_IDLE,
+        BENCH_MODE_BURST,
+        BENCH_MODE_ECHO,
+};
+
+static volatile enum bench_mode bench_mode;
+
+/* Burst accounting, updated from the notification callback */
+static volatile uint32_t burst_rx_count;
+static volatile uint32_t burst_rx_bytes;
+static volatile uint32_t burst_end;
+static uint32_t burst_expected;
+
+/* Sequence number of the echo being waited for */
+static volatile uint16_t echo_expected_seq;
+
+static struct bt_conn *default_conn;
+static uint16_t char1_handle;
+static uint16_t char2_handle;
+
+static K_SEM_DEFINE(sem_connected, 0, 1);
+static K_SEM_DEFINE(sem_step, 0, 1);
+static K_SEM_DEFINE(sem_phy, 0, 1);
+static K_SEM_DEFINE(sem_burst, 0, 1);
+static K_SEM_DEFINE(sem_echo, 0, 1);
+static K_SEM_DEFINE(sem_write, 0, 1);
+
+//////////////////////////////////////////////////////////////////////////////////
+// Helper Functions
+//////////////////////////////////////////////////////////////////////////////////
+
+static void lat_stats_add(struct lat_stats *stats, uint32_t us)
+{
+        if (stats->count == 0 || us < stats->min_us) {
+                stats->min_us = us;
+        }
+        if (us > stats->max_us) {
+                stats->max_us = us;
+        }
+        stats->sum_us += us;
+        stats->count++;
+}
+
+static uint32_t lat_stats_avg(const struct lat_stats *stats)
+{
+        return stats->count ? (uint32_t)(stats->sum_us / stats->count) : 0;
+}
+
+static uint32_t cycles_to_us(uint32_t start, uint32_t end)
+{
+        return k_cyc_to_us_floor32(end - start);
+}
+
+/* Send a single-segment message on Char2 using write without response */
+static int char2_send_cmd(const uint8_t *cmd, uint16_t len)
+{
+        uint8_t buf[PAYLOAD_MAX_MTU];
+
+        if (len + 1 > sizeof(buf)) {
+                return -EINVAL;
+        }
+
+        buf[0] = CHAR2_SEG_SINGLE;
+        memcpy(&buf[1], cmd, len);
+
+        return bt_gatt_write_without_response(default_conn, char2_handle, buf, len + 1, false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// GATT Client
+//////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t notify_cb(struct bt_conn *conn, struct bt_gatt_subscribe_params *params,
+                         const void *data, uint16_t length)
+{
+        uint32_t now = k_cycle_get_32();
+
+        if (data == NULL) {
+                LOG_INF("Unsubscribed");
+                params->value_handle = 0U;
+                return BT_GATT_ITER_STOP;
+        }
+
+        switch (bench_mode) {
+        case BENCH_MODE_BURST:
+                burst_rx_count++;
+                burst_rx_bytes += length;
+                burst_end = now;
+                if (burst_rx_count == burst_expected) {
+                        k_sem_give(&sem_burst);
+                }
+                break;
+        case BENCH_MODE_ECHO:
+                /* Only the echo of the pending request ends the round trip */
+                if (length >= 3 && ((const uint8_t *)data)[0] == CGS_OP_ECHO &&
+                    sys_get_le16((const uint8_t *)data + 1) == echo_expected_seq) {
+                        k_sem_give(&sem_echo);
+                }
+                break;
+        default:
+                break;
+        }
+
+        return BT_GATT_ITER_CONTINUE;
+}
+
+static void subscribe_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_subscribe_params *params)
+{
+        if (err) {
+                LOG_ERR("Subscribe failed (err %u)", err);
+        }
+        k_sem_give(&sem_step);
+}
+
+static struct bt_gatt_subscribe_params subscribe_params = {
+        .notify = notify_cb,
+        .subscribe = subscribe_cb,
+        .value = BT_GATT_CCC_NOTIFY,
+};
+
+static uint8_t discover_cb(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                           struct bt_gatt_discover_params *params)
+{
+        if (attr == NULL) {
+                k_sem_give(&sem_step);
+                return BT_GATT_ITER_STOP;
+        }
+
+        const struct bt_gatt_chrc *chrc = attr->user_data;
+
+        if (bt_uuid_cmp(chrc->uuid, BT_UUID_CUSTOM_CHAR1) == 0) {
+                char1_handle = chrc->value_handle;
+        } else if (bt_uuid_cmp(chrc->uuid, BT_UUID_CUSTOM_CHAR2) == 0) {
+                char2_handle = chrc->value_handle;
+        }
+
+        return BT_GATT_ITER_CONTINUE;
+}
+
+static struct bt_gatt_discover_params discover_params = {
+        .func = discover_cb,
+        .start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE,
+        .end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE,
+        .type = BT_GATT_DISCOVER_CHARACTERISTIC,
+};
+
+static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_exchange_params *params)
+{
+        LOG_INF("MTU exchange %s, MTU %u", err ? "failed" : "done", bt_gatt_get_mtu(conn));
+        k_sem_give(&sem_step);
+}
+
+static struct bt_gatt_exchange_params mtu_params = {
+        .func = mtu_exchange_cb,
+};
+
+static void write_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_write_params *params)
+{
+        if (err) {
+                LOG_ERR("Write failed (err %u)", err);
+        }
+        k_sem_give(&sem_write);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// Connection Management
+//////////////////////////////////////////////////////////////////////////////////
+
+static bool ad_name_match(struct bt_data *data, void *user_data)
+{
+        bool *match = user_data;
+
+        if (data->type == BT_DATA_NAME_COMPLETE &&
+            data->data_len == strlen(CONFIG_BENCH_PEER_NAME) &&
+            memcmp(data->data, CONFIG_BENCH_PEER_NAME, data->data_len) == 0) {
+                *match = true;
+                return false;
+        }
+
+        return true;
+}
+
+static void start_scan(void);
+
+static void device_found(const bt_addr_le_t *addr, int8_t rssi, uint8_t type,
+                         struct net_buf_simple *ad)
+{
+        bool match = false;
+
+        if (default_conn != NULL || type != BT_GAP_ADV_TYPE_ADV_IND) {
+                return;
+        }
+
+        bt_data_parse(ad, ad_name_match, &match);
+        if (!match || bt_le_scan_stop() != 0) {
+                return;
+        }
+
+        /* 7.5 ms connection interval, the fastest the peripheral accepts */
+        int err = bt_conn_le_create(addr, BT_CONN_LE_CREATE_CONN, BT_LE_CONN_PARAM(6, 6, 0, 400),
+                                    &default_conn);
+        if (err) {
+                LOG_ERR("Create connection failed (err %d)", err);
+                start_scan();
+        }
+}
+
+static void start_scan(void)
+{
+        int err = bt_le_scan_start(BT_LE_SCAN_PASSIVE, device_found);
+
+        if (err) {
+                LOG_ERR("Scanning failed to start (err %d)", err);
+        }
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+        if (err) {
+                LOG_ERR("Connection failed, err 0x%02x %s", err, bt_hci_err_to_str(err));
+                bt_conn_unref(default_conn);
+                default_conn = NULL;
+                start_scan();
+                return;
+        }
+
+        LOG_INF("Connected");
+        k_sem_give(&sem_connected);
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+        LOG_ERR("Disconnected, reason 0x%02x %s", reason, bt_hci_err_to_str(reason));
+
+        if (default_conn != NULL) {
+                bt_conn_unref(default_conn);
+                default_conn = NULL;
+        }
+}
+
+static void le_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+        LOG_INF("PHY updated: TX %u RX %u", param->tx_phy, param->rx_phy);
+        k_sem_give(&sem_phy);
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+        .connected = connected,
+        .disconnected = disconnected,
+        .le_phy_updated = le_phy_updated,
+};
+
+//////////////////////////////////////////////////////////////////////////////////
+// Benchmark
+//////////////////////////////////////////////////////////////////////////////////
+
+static int bench_set_phy(uint8_t phy)
+{
+        const struct bt_conn_le_phy_param param = {
+                .options = BT_CONN_LE_PHY_OPT_NONE,
+                .pref_tx_phy = phy,
+                .pref_rx_phy = phy,
+        };
+
+        k_sem_reset(&sem_phy);
+        int err = bt_conn_le_phy_update(default_conn, &param);
+        if (err) {
+                return err;
+        }
+
+        /* The controller reports completion even when the PHY is unchanged */
+        if (k_sem_take(&sem_phy, STEP_TIMEOUT) != 0) {
+                LOG_WRN("PHY update timed out, continuing on current PHY");
+        }
+
+        return 0;
+}
+
+static int bench_throughput(uint16_t payload_len, struct bench_result *result)
+{
+        uint8_t cmd[5] = { CGS_OP_BENCH_NOTIFY };
+
+        sys_put_le16(CONFIG_BENCH_BURST_COUNT, &cmd[1]);
+        sys_put_le16(payload_len, &cmd[3]);
+
+        /* Nothing from the previous case may leak into this one */
+        burst_rx_count = 0;
+        burst_rx_bytes = 0;
+        burst_end = 0;
+        burst_expected = CONFIG_BENCH_BURST_COUNT;
+        k_sem_reset(&sem_burst);
+        bench_mode = BENCH_MODE_BURST;
+
+        uint32_t start = k_cycle_get_32();
+        int err = char2_send_cmd(cmd, sizeof(cmd));
+
+        if (err == 0 && k_sem_take(&sem_burst, K_SECONDS(30)) != 0) {
+                LOG_WRN("Burst timed out after %u notifications", burst_rx_count);
+        }
+        bench_mode = BENCH_MODE_IDLE;
+
+        uint32_t elapsed_us = burst_rx_count ? cycles_to_us(start, burst_end) : 0;
+
+        result->rx_count = burst_rx_count;
+        result->kbps = elapsed_us ? (uint32_t)(((uint64_t)burst_rx_bytes * 8U * 1000U) / elapsed_us) : 0;
+
+        return err;
+}
+
+static int bench_echo(uint16_t payload_len, struct lat_stats *stats)
+{
+        /* The segment header takes one byte of the write, the echo carries the rest */
+        static uint8_t cmd[PAYLOAD_MAX_MTU - 1];
+        uint16_t len = MAX(payload_len - 1, 3);
+
+        memset(cmd, 0xA5, len);
+        cmd[0] = CGS_OP_ECHO;
+
+        for (int i = 0; i < CONFIG_BENCH_RTT_SAMPLES; i++) {
+                sys_put_le16(i, &cmd[1]);
+                echo_expected_seq = i;
+                k_sem_reset(&sem_echo);
+                bench_mode = BENCH_MODE_ECHO;
+
+                uint32_t start = k_cycle_get_32();
+                int err = char2_send_cmd(cmd, len);
+
+                if (err) {
+                        bench_mode = BENCH_MODE_IDLE;
+                        return err;
+                }
+                if (k_sem_take(&sem_echo, STEP_TIMEOUT) != 0) {
+                        bench_mode = BENCH_MODE_IDLE;
+                        return -ETIMEDOUT;
+                }
+                lat_stats_add(stats, cycles_to_us(start, k_cycle_get_32()));
+        }
+        bench_mode = BENCH_MODE_IDLE;
+
+        return 0;
+}
+
+static int bench_write_rtt(uint16_t payload_len, struct lat_stats *stats)
+{
+        static uint8_t value[PAYLOAD_MAX_MTU];
+        static struct bt_gatt_write_params write_params = {
+                .func = write_cb,
+                .data = value,
+        };
+
+        /* Printable filler, the peripheral keeps it as its Char2 string value */
+        memset(value, 'r', payload_len);
+        write_params.handle = char2_handle;
+        write_params.length = payload_len;
+
+        for (int i = 0; i < CONFIG_BENCH_RTT_SAMPLES; i++) {
+                k_sem_reset(&sem_write);
+
+                uint32_t start = k_cycle_get_32();
+                int err = bt_gatt_write(default_conn, &write_params);
+
+                if (err) {
+                        return err;
+                }
+                if (k_sem_take(&sem_write, STEP_TIMEOUT) != 0) {
+                        return -ETIMEDOUT;
+                }
+                lat_stats_add(stats, cycles_to_us(start, k_cycle_get_32()));
+        }
+
+        return 0;
+}
+
+static int bench_setup(void)
+{
+        int err;
+
+        bt_conn_le_data_len_update(default_conn, BT_LE_DATA_LEN_PARAM_MAX);
+
+        err = bt_gatt_exchange_mtu(default_conn, &mtu_params);
+        if (err || k_sem_take(&sem_step, STEP_TIMEOUT) != 0) {
+                LOG_ERR("MTU exchange failed (err %d)", err);
+                return -EIO;
+        }
+
+        err = bt_gatt_discover(default_conn, &discover_params);
+        if (err || k_sem_take(&sem_step, STEP_TIMEOUT) != 0 || !char1_handle || !char2_handle) {
+                LOG_ERR("Discovery failed (err %d)", err);
+                return -EIO;
+        }
+
+        /* The CCC descriptor directly follows the Char1 value in the service table */
+        subscribe_params.value_handle = char1_handle;
+        subscribe_params.ccc_handle = char1_handle + 1;
+        err = bt_gatt_subscribe(default_conn, &subscribe_params);
+        if (err || k_sem_take(&sem_step, STEP_TIMEOUT) != 0) {
+                LOG_ERR("Subscribe failed (err %d)", err);
+                return -EIO;
+        }
+
+        return 0;
+}
+
+static bool bench_report(void)
+{
+        bool passed = true;
+
+        printk("\n| PHY | Payload | Notifications | Throughput kbps | Echo us min/avg/max | Write RTT us min/avg/max | Result |\n");
+        printk("|-----|---------|---------------|-----------------|---------------------|--------------------------|--------|\n");
+
+        for (size_t i = 0; i < ARRAY_SIZE(bench_cases); i++) {
+                const struct bench_case *bc = &bench_cases[i];
+                const struct bench_result *res = &results[i];
+                bool ok = res->rx_count == CONFIG_BENCH_BURST_COUNT &&
+                          res->kbps >= bc->min_kbps &&
+                          res->echo.count == CONFIG_BENCH_RTT_SAMPLES &&
+                          res->write.count == CONFIG_BENCH_RTT_SAMPLES;
+
+                if (CONFIG_BENCH_MAX_ECHO_US && lat_stats_avg(&res->echo) > CONFIG_BENCH_MAX_ECHO_US) {
+                        ok = false;
+                }
+                if (CONFIG_BENCH_MAX_WRITE_RTT_US &&
+                    lat_stats_avg(&res->write) > CONFIG_BENCH_MAX_WRITE_RTT_US) {
+                        ok = false;
+                }
+
+                printk("| %-3s | %7u | %6u/%-6u | %15u | %5u/%5u/%5u | %6u/%6u/%6u | %-6s |\n",
+                       bc->phy_name, bc->payload_len, res->rx_count, CONFIG_BENCH_BURST_COUNT,
+                       res->kbps, res->echo.min_us, lat_stats_avg(&res->echo), res->echo.max_us,
+                       res->write.min_us, lat_stats_avg(&res->write), res->write.max_us,
+                       ok ? "PASS" : "FAIL");
+                passed = passed && ok;
+        }
+
+        return passed;
+}
+
+static void bench_exit(bool passed)
+{
+        printk("Benchmark %s\n", passed ? "PASSED" : "FAILED");
+
+#if defined(CONFIG_ARCH_POSIX)
+        nsi_exit(passed ? 0 : 1);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// Main Application
+//////////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+        int err = bt_enable(NULL);
+        if (err) {
+                LOG_ERR("Bluetooth init failed (err %d)", err);
+                bench_exit(false);
+                return -1;
+        }
+
+        start_scan();
+        if (k_sem_take(&sem_connected, K_SECONDS(CONFIG_BENCH_CONNECT_TIMEOUT_S)) != 0) {
+                LOG_ERR("Peripheral \"%s\" not found", CONFIG_BENCH_PEER_NAME);
+                bench_exit(false);
+                return -1;
+        }
+
+        if (bench_setup() != 0) {
+                bench_exit(false);
+                return -1;
+        }
+
+        for (size_t i = 0; i < ARRAY_SIZE(bench_cases) && default_conn != NULL; i++) {
+                const struct bench_case *bc = &bench_cases[i];
+
+                LOG_INF("Case %s PHY, %u byte payload", bc->phy_name, bc->payload_len);
+                if (bench_set_phy(bc->phy) != 0) {
+                        LOG_WRN("PHY %s not supported", bc->phy_name);
+                }
+
+                err = bench_throughput(bc->payload_len, &results[i]);
+                if (!err) {
+                        err = bench_echo(bc->payload_len, &results[i].echo);
+                }
+                if (!err) {
+                        err = bench_write_rtt(bc->payload_len, &results[i].write);
+                }
+                if (err) {
+                        LOG_ERR("Case %zu failed (err %d)", i, err);
+                }
+        }
+
+        bench_exit(bench_report());
+
+        return 0;
+}
@@ -4,9 +4,16 @@
 *
 * Description: Custom GATT Service with 2 Characteristics
 * 1. Characteristic 1: Read and Notify
-* 2. Characteristic 2: Write Only
+* 2. Characteristic 2: Write / Write Without Response command channel
 * Notifications are sent every 60 seconds with incrementing value
-* Write Characteristic logs the written value and the data length, offset and data received
+* Characteristic 2 reassembles long (prepared) writes and write-without-response
+* segment streams into a buffer of CONFIG_APP_CHAR2_BUF_SIZE bytes and hands each
+* completed message to a dedicated work queue for processing
+* With CONFIG_APP_BENCH, messages starting with a benchmark opcode (CGS_OP_*) trigger notification bursts
+* or echoes, used by bluetooth/central_bench to measure throughput and latency
+* Custom service state (last Char2 value, counters) is persisted
+* through a write-behind cache that commits to settings/NVS on idle, disconnect or
+* after at most CONFIG_APP_SETTINGS_MAX_DELAY_S seconds
 * The peripheral advertises and waits for a central to connect. Once connected, it starts sending notifications
 * on Characteristic 1 every 60 seconds for a total of 10 notifications.
 * If no central connects within 60 seconds, it logs that no device is connected and exits
@@ -31,12 +38,14 @@
 #include <zephyr/init.h>
 #include <zephyr/sys/check.h>
 #include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
 
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/hci.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
+#include <zephyr/settings/settings.h>
 #include <zephyr/logging/log.h>
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +62,18 @@ LOG_MODULE_REGISTER(main);
 #define MAX_LENGTH 32
 #define MAX_NOTIFY_COUNT 10
 
+/* Char2 write-without-response segment header, first byte of every write command */
+#define CHAR2_SEG_START BIT(0) // Discard any partial message and start a new one
+#define CHAR2_SEG_END BIT(1)   // Last segment, message is complete
+#define CHAR2_SEG_HDR_LEN 1
+
+#if defined(CONFIG_APP_BENCH)
+/* Benchmark opcodes carried in Char2 messages, driven by bluetooth/central_bench */
+#define CGS_OP_BENCH_NOTIFY 0xB1 // u16 count, u16 length: burst of Char1 notifications
+#define CGS_OP_ECHO 0xB2         // Echo the message back as a Char1 notification
+#define CGS_BENCH_MAX_PAYLOAD (CONFIG_BT_L2CAP_TX_MTU - 3)
+#endif
+
 /* 128-bit UUID for custom service */
 #define BT_UUID_CUSTOM_SERVICE_VAL BT_UUID_128_ENCODE(0x8a5c1d32, 0x4c7e, 0x4d8b, 0xb0c4, 0x3f9f79dbd6f1)
 #define BT_UUID_CUSTOM_SERVICE BT_UUID_DECLARE_128(BT_UUID_CUSTOM_SERVICE_VAL)
@@ -77,18 +98,72 @@ struct bt_cgs_cb {
 
 /* Global variables for characteristic values and state */ 
 static uint8_t cgs_blsc;
+static uint32_t cgs_notify_count;
 //static sys_slist_t cgs_cbs = SYS_SLIST_STATIC_INIT(&cgs_cbs);
 
 /* Characteristic values */
-static char char1_value[32] = "Hello from peripheral";
-static char char2_value[32] = {0};
+static char char1_value[MAX_LENGTH] = "Hello from peripheral";
+static char char2_value[MAX_LENGTH] = {0};
+
+/* Reassembled Char2 message handed over to the command work queue */
+struct char2_msg {
+        void *fifo_reserved;
+        size_t len;
+        uint8_t data[CONFIG_APP_CHAR2_BUF_SIZE];
+};
+
+K_MEM_SLAB_DEFINE_STATIC(char2_slab, sizeof(struct char2_msg), CONFIG_APP_CHAR2_BUF_COUNT, 4);
+static K_FIFO_DEFINE(char2_fifo);
+
+/*
+ * Messages currently being reassembled, only touched from the BT RX context.
+ * Long (prepared) writes get their own buffer so they never overwrite a
+ * write-without-response stream that is still open.
+ */
+static struct char2_msg *char2_rx;
+static struct char2_msg *char2_long;
+static uint16_t char2_long_total;       // Value length announced by the prepare pass
+
+/* Char2 statistics */
+static uint32_t char2_msg_count;
+static uint32_t char2_drop_count;
+
+/* Persisted service state, stored as a single "cgs/state" record */
+struct cgs_state {
+        uint8_t blsc;
+        uint8_t unused;         // Was the Char1 CCC value, BT_SETTINGS stores CCCs per bond
+        uint16_t reserved;
+        uint32_t char2_msgs;
+        uint32_t char2_drops;
+        uint32_t notifications;
+} __packed;
+
+/* Write-behind cache dirty flags, one per settings record */
+enum {
+        CGS_DIRTY_STATE,
+        CGS_DIRTY_CHAR2,
+        CGS_DIRTY_BITS,
+};
+
+static ATOMIC_DEFINE(cgs_dirty, CGS_DIRTY_BITS);
+static int64_t cgs_dirty_since; // Uptime of the oldest unsaved change, 0 if clean
+static struct k_spinlock cgs_dirty_lock; // Guards cgs_dirty_since
+
+/* Command work queue */
+static K_THREAD_STACK_DEFINE(cmd_workq_stack, CONFIG_APP_CMD_WORKQ_STACK_SIZE);
+static struct k_work_q cmd_workq;
 
 //////////////////////////////////////////////////////////////////////////////////
 // Function Prototypes
 //////////////////////////////////////////////////////////////////////////////////
 
-/* Load settings for notifications */
-void settings_load(void);
+/* Mark a settings record as changed, it is committed later by the write-behind cache */
+static void cgs_settings_mark_dirty(int bit);
+
+#if defined(CONFIG_APP_BENCH)
+/* Handle a benchmark opcode message, returns true if the message was one */
+static bool cgs_bench_handle(const uint8_t *data, size_t len);
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////
 // Helper Functions and GATT Characteristics & Service Declaration
@@ -102,23 +177,177 @@ static ssize_t read_char1(struct bt_conn *conn, const struct bt_gatt_attr *attr,
     return bt_gatt_attr_read(conn, attr, buf, len, offset, value, strlen(value));
 }
 
+/* Get the message being reassembled in slot, allocating a free buffer if needed */
+static struct char2_msg *char2_rx_get(struct char2_msg **slot)
+{
+    if (*slot == NULL) {
+        if (k_mem_slab_alloc(&char2_slab, (void **)slot, K_NO_WAIT) != 0) {
+            char2_drop_count++;
+            cgs_settings_mark_dirty(CGS_DIRTY_STATE);
+            return NULL;
+        }
+        (*slot)->len = 0;
+    }
+
+    return *slot;
+}
+
+/* Process a completed Char2 message, runs on the command work queue */
+static void char2_process(const struct char2_msg *msg)
+{
+    size_t str_len = MIN(msg->len, sizeof(char2_value) - 1);
+
+#if defined(CONFIG_APP_BENCH)
+    if (cgs_bench_handle(msg->data, msg->len)) {
+        return;
+    }
+#endif
+
+    memcpy(char2_value, msg->data, str_len);
+    char2_value[str_len] = '\0';
+    char2_msg_count++;
+    cgs_settings_mark_dirty(CGS_DIRTY_CHAR2);
+    cgs_settings_mark_dirty(CGS_DIRTY_STATE);
+
+    LOG_INF("Char2 message %u received: %zu bytes", char2_msg_count, msg->len);
+    LOG_HEXDUMP_DBG(msg->data, MIN(msg->len, 64), "Char2 data");
+}
+
+static void cmd_work_handler(struct k_work *work)
+{
+    struct char2_msg *msg;
+
+    while ((msg = k_fifo_get(&char2_fifo, K_NO_WAIT)) != NULL) {
+        char2_process(msg);
+        k_mem_slab_free(&char2_slab, msg);
+    }
+}
+
+static K_WORK_DEFINE(cmd_work, cmd_work_handler);
+
+/* Hand the completed message in slot over to the command work queue */
+static void char2_rx_submit(struct char2_msg **slot)
+{
+    k_fifo_put(&char2_fifo, *slot);
+    *slot = NULL;
+    k_work_submit_to_queue(&cmd_workq, &cmd_work);
+}
+
+/* Write Without Response: append one segment to the current message */
+static ssize_t write_char2_segment(const uint8_t *data, uint16_t len)
+{
+    if (len < CHAR2_SEG_HDR_LEN) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    uint8_t seg = data[0];
+    uint16_t payload_len = len - CHAR2_SEG_HDR_LEN;
+    struct char2_msg *msg = char2_rx_get(&char2_rx);
+
+    if (msg == NULL) {
+        return BT_GATT_ERR(BT_ATT_ERR_INSUFFICIENT_RESOURCES);
+    }
+
+    if (seg & CHAR2_SEG_START) {
+        msg->len = 0;
+    }
+
+    if (msg->len + payload_len > sizeof(msg->data)) {
+        LOG_WRN("Char2 message exceeds %d bytes, dropped", CONFIG_APP_CHAR2_BUF_SIZE);
+        msg->len = 0;
+        char2_drop_count++;
+        cgs_settings_mark_dirty(CGS_DIRTY_STATE);
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    memcpy(&msg->data[msg->len], &data[CHAR2_SEG_HDR_LEN], payload_len);
+    msg->len += payload_len;
+
+    if (seg & CHAR2_SEG_END) {
+        char2_rx_submit(&char2_rx);
+    }
+
+    return len;
+}
+
+/* GATT characteristic 2 write: acknowledged, long (prepared) and unacknowledged writes */
 static ssize_t write_char2(struct bt_conn *conn, const struct bt_gatt_attr *attr, 
                             const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
 {
-    LOG_INF("Written to Char2: len=%d, offset=%d", len, offset);
-    LOG_INF("Data: %.*s", len, (char *)buf);
+    LOG_DBG("Written to Char2: len=%d, offset=%d, flags=0x%02x", len, offset, flags);
 
-    char *value = (char *)attr->user_data;
-    if (offset + len > sizeof(char2_value)) {
+    if (offset > CONFIG_APP_CHAR2_BUF_SIZE) {
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
     }
-    memcpy(value + offset, buf, len);
-    value[offset + len] = '\0'; // Null-terminate the string
-    LOG_INF("Char2 value updated to: %s", value);
+    if (offset + len > CONFIG_APP_CHAR2_BUF_SIZE) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    /*
+     * Prepare Write Request: only validate and note where the value ends,
+     * the data is written again chunk by chunk on execute
+     */
+    if (flags & BT_GATT_WRITE_FLAG_PREPARE) {
+        if (offset == 0) {
+            char2_long_total = 0;
+        }
+        char2_long_total = MAX(char2_long_total, offset + len);
+        return 0;
+    }
+
+    if (flags & BT_GATT_WRITE_FLAG_CMD) {
+        return write_char2_segment(buf, len);
+    }
+
+    /* Write Request: the value is complete once written */
+    if (!(flags & BT_GATT_WRITE_FLAG_EXECUTE)) {
+        struct char2_msg *req = NULL;
+
+        if (offset != 0) {
+            return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+        }
+        if (char2_rx_get(&req) == NULL) {
+            return BT_GATT_ERR(BT_ATT_ERR_INSUFFICIENT_RESOURCES);
+        }
+        memcpy(req->data, buf, len);
+        req->len = len;
+        char2_rx_submit(&req);
+        return len;
+    }
+
+    /* Execute Write: one call per prepared chunk, reassembled in order */
+    struct char2_msg *msg = char2_rx_get(&char2_long);
+
+    if (msg == NULL) {
+        return BT_GATT_ERR(BT_ATT_ERR_INSUFFICIENT_RESOURCES);
+    }
+
+    if (offset == 0) {
+        msg->len = 0;
+    }
+    if (offset != msg->len) {
+        LOG_WRN("Char2 long write gap at offset %u, expected %zu, dropped", offset, msg->len);
+        msg->len = 0;
+        char2_drop_count++;
+        cgs_settings_mark_dirty(CGS_DIRTY_STATE);
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    memcpy(&msg->data[offset], buf, len);
+    msg->len += len;
+    if (msg->len >= char2_long_total) {
+        char2_rx_submit(&char2_long);
+    }
 
     return len;
 }
 
+/* Char1 CCC changed, the stack keeps the value per bonded peer */
+static void cgs_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    LOG_INF("Char1 notifications %s", value == BT_GATT_CCC_NOTIFY ? "enabled" : "disabled");
+}
+
 /* Custom Service Declaration */
 BT_GATT_SERVICE_DEFINE(custom_svc,
     BT_GATT_PRIMARY_SERVICE(BT_UUID_CUSTOM_SERVICE),
@@ -126,10 +355,10 @@ BT_GATT_SERVICE_DEFINE(custom_svc,
                            BT_GATT_CHRC_READ  | BT_GATT_CHRC_NOTIFY,
                            BT_GATT_PERM_READ , 
                            read_char1, NULL, char1_value),
-    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CCC(cgs_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
     BT_GATT_CHARACTERISTIC(BT_UUID_CUSTOM_CHAR2,
-                           BT_GATT_CHRC_WRITE,
-                           BT_GATT_PERM_WRITE,
+                           BT_GATT_CHRC_WRITE | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+                           BT_GATT_PERM_WRITE | BT_GATT_PERM_PREPARE_WRITE,
                            NULL, write_char2, NULL),
 );
 
@@ -142,11 +371,137 @@ static int cgs_init(void)
 {
 	cgs_blsc = 0x01;
 
+	k_work_queue_start(&cmd_workq, cmd_workq_stack, K_THREAD_STACK_SIZEOF(cmd_workq_stack),
+			   CONFIG_APP_CMD_WORKQ_PRIORITY, NULL);
+	k_thread_name_set(&cmd_workq.thread, "cmd_workq");
+
 	return 0;
 }
 
 SYS_INIT(cgs_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
 
+///////////////////////////////////////////////////////////////////////////////
+// Persistent State (settings write-behind cache)
+///////////////////////////////////////////////////////////////////////////////
+
+/* Commit all dirty records to settings, runs on the command work queue */
+static void cgs_settings_flush(struct k_work *work)
+{
+	k_spinlock_key_t key = k_spin_lock(&cgs_dirty_lock);
+	int err;
+
+	cgs_dirty_since = 0;
+	k_spin_unlock(&cgs_dirty_lock, key);
+
+	if (atomic_test_and_clear_bit(cgs_dirty, CGS_DIRTY_STATE)) {
+		const struct cgs_state state = {
+			.blsc = cgs_blsc,
+			.char2_msgs = char2_msg_count,
+			.char2_drops = char2_drop_count,
+			.notifications = cgs_notify_count,
+		};
+
+		err = settings_save_one("cgs/state", &state, sizeof(state));
+		if (err) {
+			LOG_ERR("Saving cgs/state failed (err %d)", err);
+		}
+	}
+
+	if (atomic_test_and_clear_bit(cgs_dirty, CGS_DIRTY_CHAR2)) {
+		err = settings_save_one("cgs/char2", char2_value, strlen(char2_value) + 1);
+		if (err) {
+			LOG_ERR("Saving cgs/char2 failed (err %d)", err);
+		}
+	}
+
+	LOG_DBG("Service state committed");
+}
+
+static K_WORK_DELAYABLE_DEFINE(cgs_flush_work, cgs_settings_flush);
+
+/*
+ * Every change pushes the commit out by CONFIG_APP_SETTINGS_IDLE_MS so bursts of
+ * updates coalesce into one NVS write, but never beyond CONFIG_APP_SETTINGS_MAX_DELAY_S
+ * after the oldest unsaved change.
+ */
+static void cgs_settings_mark_dirty(int bit)
+{
+	if (!IS_ENABLED(CONFIG_SETTINGS)) {
+		return;
+	}
+
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&cgs_dirty_lock);
+
+	atomic_set_bit(cgs_dirty, bit);
+	if (cgs_dirty_since == 0) {
+		cgs_dirty_since = now;
+	}
+
+	int64_t deadline = cgs_dirty_since + CONFIG_APP_SETTINGS_MAX_DELAY_S * MSEC_PER_SEC;
+
+	k_spin_unlock(&cgs_dirty_lock, key);
+
+	int64_t delay = MIN((int64_t)CONFIG_APP_SETTINGS_IDLE_MS, MAX(deadline - now, 0));
+
+	k_work_reschedule_for_queue(&cmd_workq, &cgs_flush_work, K_MSEC(delay));
+}
+
+/* Commit pending changes right away, e.g. on disconnect */
+static void cgs_settings_flush_now(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&cgs_dirty_lock);
+	bool dirty = cgs_dirty_since != 0;
+
+	k_spin_unlock(&cgs_dirty_lock, key);
+
+	if (IS_ENABLED(CONFIG_SETTINGS) && dirty) {
+		k_work_reschedule_for_queue(&cmd_workq, &cgs_flush_work, K_NO_WAIT);
+	}
+}
+
+/* Restore the "cgs" subtree at boot */
+static int cgs_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	const char *next;
+	ssize_t rc;
+
+	if (settings_name_steq(name, "state", &next) && !next) {
+		struct cgs_state state;
+
+		if (len != sizeof(state)) {
+			return -EINVAL;
+		}
+		rc = read_cb(cb_arg, &state, sizeof(state));
+		if (rc < 0) {
+			return rc;
+		}
+
+		cgs_blsc = state.blsc;
+		char2_msg_count = state.char2_msgs;
+		char2_drop_count = state.char2_drops;
+		cgs_notify_count = state.notifications;
+		return 0;
+	}
+
+	if (settings_name_steq(name, "char2", &next) && !next) {
+		if (len > sizeof(char2_value)) {
+			return -EINVAL;
+		}
+		rc = read_cb(cb_arg, char2_value, len);
+		if (rc < 0) {
+			return rc;
+		}
+
+		char2_value[sizeof(char2_value) - 1] = '\0';
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(cgs, "cgs", NULL, cgs_settings_set, NULL, NULL);
+
 ///////////////////////////////////////////////////////////////////////////////
 // Advertisement
 ///////////////////////////////////////////////////////////////////////////////
@@ -168,8 +523,12 @@ static void bt_ready(void)
 
 	LOG_ERR("Bluetooth initialized\n");
 
+	/* Only the subtrees this application owns, not every registered handler */
 	if (IS_ENABLED(CONFIG_SETTINGS)) {
-		settings_load();
+		settings_load_subtree("bt");
+		settings_load_subtree("cgs");
+		LOG_INF("Restored state: Char2 \"%s\", %u messages, %u notifications",
+			char2_value, char2_msg_count, cgs_notify_count);
 	}
 
 	err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
@@ -194,6 +553,8 @@ enum {
 
 static ATOMIC_DEFINE(state, STATE_BITS);
 
+static struct bt_conn *current_conn;
+
 /* Connection callbacks */
 static void connected(struct bt_conn *conn, uint8_t err)
 {
@@ -201,6 +562,7 @@ static void connected(struct bt_conn *conn, uint8_t err)
                 LOG_ERR("Connection failed, err 0x%02x %s\n", err, bt_hci_err_to_str(err));
         } else {
                 LOG_INF("Connected\n");
+                current_conn = bt_conn_ref(conn);
                 atomic_clear_bit(state, STATE_DISCONNECTED);
                 atomic_set_bit(state, STATE_CONNECTED);
         }
@@ -212,6 +574,21 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 
         atomic_clear_bit(state, STATE_CONNECTED);
         atomic_set_bit(state, STATE_DISCONNECTED);
+        if (current_conn != NULL) {
+                bt_conn_unref(current_conn);
+                current_conn = NULL;
+        }
+
+        /* Drop any partially reassembled Char2 message */
+        if (char2_rx != NULL) {
+                char2_rx->len = 0;
+        }
+        if (char2_long != NULL) {
+                char2_long->len = 0;
+        }
+        char2_long_total = 0;
+        LOG_INF("Char2: %u messages processed, %u dropped", char2_msg_count, char2_drop_count);
+        cgs_settings_flush_now();
 }
 
 /* Connection callback structure definition */
@@ -234,6 +611,8 @@ int bt_cgs_notify(uint8_t value)
     int ret = bt_gatt_notify(NULL, &custom_svc.attrs[1], cgm, sizeof(cgm));
     
     if (ret == 0) {
+        cgs_notify_count++;
+        cgs_settings_mark_dirty(CGS_DIRTY_STATE);
         LOG_INF("Sending notification: %02x %02x", cgm[0], cgm[1]);
     } else {
         LOG_ERR("Notification failed (err %d)", ret);
@@ -243,6 +622,65 @@ int bt_cgs_notify(uint8_t value)
     return 0;
 }
 
+#if defined(CONFIG_APP_BENCH)
+/* Send raw data as a Char1 notification, waiting while TX buffers are in use */
+static int cgs_notify_data(const void *data, uint16_t len)
+{
+    int ret;
+
+    do {
+        if (!atomic_test_bit(state, STATE_CONNECTED)) {
+            return -ENOTCONN;
+        }
+        ret = bt_gatt_notify(current_conn, &custom_svc.attrs[1], data, len);
+        if (ret == -ENOMEM) {
+            k_sleep(K_MSEC(1));
+        }
+    } while (ret == -ENOMEM);
+
+    return ret;
+}
+
+static bool cgs_bench_handle(const uint8_t *data, size_t len)
+{
+    static uint8_t payload[CGS_BENCH_MAX_PAYLOAD];
+
+    if (len == 0 || !atomic_test_bit(state, STATE_CONNECTED)) {
+        return false;
+    }
+
+    uint16_t max_len = MIN(sizeof(payload), bt_gatt_get_mtu(current_conn) - 3);
+
+    switch (data[0]) {
+    case CGS_OP_BENCH_NOTIFY:
+        if (len < 5) {
+            return false;
+        }
+
+        uint16_t count = MIN(sys_get_le16(&data[1]), CONFIG_APP_BENCH_MAX_NOTIFY);
+        uint16_t ntf_len = CLAMP(sys_get_le16(&data[3]), sizeof(uint16_t), max_len);
+
+        /* Every notification carries its sequence number in the first 2 bytes */
+        for (uint16_t seq = 0; seq < count; seq++) {
+            sys_put_le16(seq, payload);
+            if (cgs_notify_data(payload, ntf_len)) {
+                LOG_ERR("Benchmark burst aborted at %u", seq);
+                break;
+            }
+        }
+        LOG_INF("Benchmark burst: %u notifications of %u bytes", count, ntf_len);
+        return true;
+
+    case CGS_OP_ECHO:
+        cgs_notify_data(data, MIN(len, max_len));
+        return true;
+
+    default:
+        return false;
+    }
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////
 // Main Application
 //////////////////////////////////////////////////////////////////////////////////
@@ -16,7 +16,7 @@
 #include <zephyr/sys/printk.h>
 #include <inttypes.h>
 
-#define SLEEP_TIME_MS	1
+#include "button_input.h"
 
 /*
  * Get button configuration from the devicetree sw0 alias. This is mandatory.
@@ -25,12 +25,8 @@
 #if !DT_NODE_HAS_STATUS_OKAY(SW0_NODE)
 #error "Unsupported board: sw0 devicetree alias is not defined"
 #endif
-static const struct gpio_dt_spec button = {
-	.port = GPIO_DT_SPEC_GET(DT_NODELABEL(SW0_NODE)),
-	.pin = 13,
-	.dt_flags = GPIO_ACTIVE_HIGH
-};
-static struct gpio_callback button_cb_data;
+static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET(SW0_NODE, gpios);
+static struct button_input button_in;
 
 /*
  * The led0 devicetree alias is optional. If present, we'll use it
@@ -40,40 +36,23 @@ static struct gpio_callback button_cb_data;
 static struct gpio_dt_spec led = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led1), gpios,
 						     {0});
 
-void button_pressed(const struct device *dev, struct gpio_callback *cb,
-		    uint32_t pins)
+/*
+ * Runs on the input work queue: the ISR only timestamped and queued the edge.
+ */
+static void button_event(struct button_input *btn, enum button_evt evt,
+			 uint32_t edge_cycles)
 {
-	printk("Button pressed at %" PRIu32 "\n", k_cycle_get_32());
+	printk("Button %s, edge at %" PRIu32 "\n", button_evt_str(evt), edge_cycles);
+
+	/* If we have an LED, match its state to the button's. */
+	if (led.port && (evt == BUTTON_EVT_PRESS || evt == BUTTON_EVT_RELEASE)) {
+		gpio_pin_set_dt(&led, evt == BUTTON_EVT_PRESS);
+	}
 }
 
 int main(void)
 {
-	int ret;
-
-	if (!gpio_is_ready_dt(&button)) {
-		printk("Error: button device %s is not ready\n",
-		       button.port->name);
-		return 0;
-	}
-
-	ret = gpio_pin_configure_dt(&button, GPIO_INPUT);
-	if (ret != 0) {
-		printk("Error %d: failed to configure %s pin %d\n",
-		       ret, button.port->name, button.pin);
-		return 0;
-	}
-
-	ret = gpio_pin_interrupt_configure_dt(&button,
-					      GPIO_INT_EDGE_TO_ACTIVE);
-	if (ret != 0) {
-		printk("Error %d: failed to configure interrupt on %s pin %d\n",
-			ret, button.port->name, button.pin);
-		return 0;
-	}
-
-	gpio_init_callback(&button_cb_data, button_pressed, BIT(button.pin));
-	gpio_add_callback(button.port, &button_cb_data);
-	printk("Set up button at %s pin %d\n", button.port->name, button.pin);
+	int ret = 0;
 
 	if (led.port && !gpio_is_ready_dt(&led)) {
 		printk("Error %d: LED device %s is not ready; ignoring it\n",
@@ -81,7 +60,7 @@ int main(void)
 		led.port = NULL;
 	}
 	if (led.port) {
-		ret = gpio_pin_configure_dt(&led, GPIO_OUTPUT);
+		ret = gpio_pin_configure_dt(&led, GPIO_OUTPUT_INACTIVE);
 		if (ret != 0) {
 			printk("Error %d: failed to configure LED device %s pin %d\n",
 			       ret, led.port->name, led.pin);
@@ -91,24 +70,14 @@ int main(void)
 		}
 	}
 
-	printk("Press the button\n");
-	if (led.port) {
-		int ret_led = gpio_pin_configure_dt(&led, GPIO_OUTPUT_ACTIVE);
-		while (1) {
-			/* If we have an LED, match its state to the button's. */
-			int val = gpio_pin_get_dt(&button);
-
-			if (val == 0) {
-				//gpio_pin_set_dt(&led, val);
-				ret_led = gpio_pin_toggle_dt(&led);
-
-			}
-			else if(val == 1)
-			{
-				ret_led = gpio_pin_toggle_dt(&led);
-			}
-			k_msleep(SLEEP_TIME_MS);
-		}
+	ret = button_input_init(&button_in, &button, button_event, NULL);
+	if (ret != 0) {
+		printk("Error %d: failed to set up button %s pin %d\n",
+		       ret, button.port->name, button.pin);
+		return 0;
 	}
+	printk("Set up button at %s pin %d\n", button.port->name, button.pin);
+
+	printk("Press the button\n");
 	return 0;
 }
@@ -10,15 +10,32 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/drivers/pwm.h>
 #include <inttypes.h>
-static const struct pwm_dt_spec pwm_led1 = PWM_DT_SPEC_GET(DT_ALIAS(pwm_led1));
 
-#define MIN_PERIOD PWM_SEC(1U) / 128U
-#define MAX_PERIOD PWM_SEC(1U)
-#define SLEEP_TIME_MS	1
+#include "button_input.h"
+#include "led_fade.h"
+
+/*
+ * pwm_led1 is mandatory, pwm_led0 and pwm_led2 breathe along when the
+ * board defines them.
+ */
+#define FADE_PWM(alias) \
+	IF_ENABLED(DT_NODE_EXISTS(DT_ALIAS(alias)), (PWM_DT_SPEC_GET(DT_ALIAS(alias)),))
+
+static const struct pwm_dt_spec pwm_leds[] = {
+	PWM_DT_SPEC_GET(DT_ALIAS(pwm_led1)),
+	FADE_PWM(pwm_led0)
+	FADE_PWM(pwm_led2)
+};
+
+static struct led_fade_channel fades[ARRAY_SIZE(pwm_leds)];
+
+/* Time for one ramp from off to full brightness or back */
+#define BREATH_MS	2000U
 
 /*
  * Get button configuration from the devicetree sw0 alias. This is mandatory.
@@ -28,77 +45,83 @@ static const struct pwm_dt_spec pwm_led1 = PWM_DT_SPEC_GET(DT_ALIAS(pwm_led1));
 #error "Unsupported board: sw0 devicetree alias is not defined"
 #endif
 static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET_OR(SW0_NODE, gpios, {0});
-static struct gpio_callback button_cb_data;
+static struct button_input button_in;
 
-/*
- * The led0 devicetree alias is optional. If present, we'll use it
- * to turn on the LED whenever the button is pressed.
- */
-static struct gpio_dt_spec led = GPIO_DT_SPEC_GET_OR(DT_ALIAS(led0), gpios,{0});
+/* Set from the input work queue, read by the fade work item */
+static atomic_t paused;
 
-void button_pressed(const struct device *dev, struct gpio_callback *cb,
-		    uint32_t pins)
+/* Breathe: every finished ramp starts the ramp back the other way */
+static void fade_done(struct led_fade_channel *ch)
 {
-	printk("Button pressed at %" PRIu32 "\n", k_cycle_get_32());
+	if (!atomic_get(&paused)) {
+		led_fade_to(ch, led_fade_level(ch) ? 0 : 255, BREATH_MS);
+	}
 }
 
+static void fade_all(uint8_t level, uint32_t duration_ms)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(fades); i++) {
+		led_fade_to(&fades[i], level, duration_ms);
+	}
+}
+
+/*
+ * Runs on the input work queue. Click pauses or resumes breathing, a long
+ * press holds every LED at full brightness until the next click. A double
+ * click counts as one click, it does not toggle twice.
+ */
+static void button_event(struct button_input *btn, enum button_evt evt,
+			 uint32_t edge_cycles)
+{
+	switch (evt) {
+	case BUTTON_EVT_CLICK:
+	case BUTTON_EVT_DOUBLE_CLICK:
+		if (atomic_get(&paused)) {
+			atomic_clear(&paused);
+			fade_all(255, BREATH_MS);
+		} else {
+			atomic_set(&paused, 1);
+			fade_all(0, BREATH_MS / 8U);
+		}
+		break;
+	case BUTTON_EVT_LONG_PRESS:
+		atomic_set(&paused, 1);
+		fade_all(255, BREATH_MS / 8U);
+		break;
+	default:
+		return;
+	}
+	printk("Button %s at %" PRIu32 "\n", button_evt_str(evt), edge_cycles);
+}
 
 int main(void)
 {
-	uint32_t max_period;
-	uint32_t period;
-	uint8_t dir = 0U;
 	int ret;
 
-	printk("PWM-based blinky\n");
-
-	if (!pwm_is_ready_dt(&pwm_led1)) {
-		printk("Error: PWM device %s is not ready\n",
-		       pwm_led1.dev->name);
-		return 0;
-	}
+	printk("PWM-based fade\n");
 
-	/*
-	 * In case the default MAX_PERIOD value cannot be set for
-	 * some PWM hardware, decrease its value until it can.
-	 *
-	 * Keep its value at least MIN_PERIOD * 4 to make sure
-	 * the sample changes frequency at least once.
-	 */
-	printk("Calibrating for channel %d...\n", pwm_led1.channel);
-	max_period = MAX_PERIOD;
-	while (pwm_set_dt(&pwm_led1, max_period, max_period / 2U)) {
-		max_period /= 2U;
-		if (max_period < (4U * MIN_PERIOD)) {
-			printk("Error: PWM device "
-			       "does not support a period at least %lu\n",
-			       4U * MIN_PERIOD);
+	for (size_t i = 0; i < ARRAY_SIZE(pwm_leds); i++) {
+		ret = led_fade_channel_init(&fades[i], &pwm_leds[i], fade_done);
+		if (ret < 0) {
+			printk("Error %d: PWM device %s channel %d not usable\n",
+			       ret, pwm_leds[i].dev->name, pwm_leds[i].channel);
 			return 0;
 		}
+		printk("Channel %d: %u cycles per period\n", pwm_leds[i].channel,
+		       fades[i].period_cycles);
 	}
 
-	printk("Done calibrating; maximum/minimum periods %u/%lu nsec\n",
-	       max_period, MIN_PERIOD);
-
-	period = max_period;
-	while (1) {
-		ret = pwm_set_dt(&pwm_led1, period, period / 2U);
-		if (ret) {
-			printk("Error %d: failed to set pulse width\n", ret);
-			return 0;
-		}
-		printk("Using period %d\n", period);
-
-		period = dir ? (period * 2U) : (period / 2U);
-		if (period > max_period) {
-			period = max_period / 2U;
-			dir = 0U;
-		} else if (period < MIN_PERIOD) {
-			period = MIN_PERIOD * 2U;
-			dir = 1U;
-		}
+	/* Stagger the first ramps so the channels breathe out of phase */
+	for (size_t i = 0; i < ARRAY_SIZE(fades); i++) {
+		led_fade_to(&fades[i], 255, BREATH_MS * (i + 1) / ARRAY_SIZE(fades));
+	}
 
-		k_sleep(K_SECONDS(4U));
+	ret = button_input_init(&button_in, &button, button_event, NULL);
+	if (ret < 0) {
+		printk("Error %d: failed to set up button %s pin %d\n",
+		       ret, button.port->name, button.pin);
+		return 0;
 	}
+	printk("Click to pause, long press for full brightness\n");
 	return 0;
 }
@@ -0,0 +1,186 @@
+/*
+ * Button input events
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/atomic.h>
+#include <errno.h>
+
+#include "button_input.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_APP_INPUT_EDGE_QUEUE_LEN),
+	     "CONFIG_APP_INPUT_EDGE_QUEUE_LEN must be a power of two");
+
+#define EDGE_MASK	(CONFIG_APP_INPUT_EDGE_QUEUE_LEN - 1)
+
+K_THREAD_STACK_DEFINE(input_workq_stack, CONFIG_APP_INPUT_WORKQ_STACK_SIZE);
+static struct k_work_q input_workq;
+
+/* ISR: timestamp, enqueue, re-arm debounce. Single producer per button. */
+static void button_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+	struct button_input *btn = CONTAINER_OF(cb, struct button_input, cb);
+	uint32_t now = k_cycle_get_32();
+	atomic_val_t head = atomic_get(&btn->head);
+
+	if (head - atomic_get(&btn->tail) < CONFIG_APP_INPUT_EDGE_QUEUE_LEN) {
+		btn->edges[head & EDGE_MASK] = now;
+		atomic_set(&btn->head, head + 1);
+	} else {
+		atomic_inc(&btn->overflows);
+	}
+
+	k_work_reschedule_for_queue(&input_workq, &btn->debounce_work,
+				    K_MSEC(CONFIG_APP_INPUT_DEBOUNCE_MS));
+}
+
+/* Consume the queued edges, returns the stamp of the first one */
+static uint32_t drain_edges(struct button_input *btn)
+{
+	atomic_val_t tail = atomic_get(&btn->tail);
+	atomic_val_t head = atomic_get(&btn->head);
+	uint32_t first = k_cycle_get_32();
+
+	if (head != tail) {
+		first = btn->edges[tail & EDGE_MASK];
+		btn->bounces += head - tail - 1;
+	}
+	atomic_set(&btn->tail, head);
+	return first;
+}
+
+static void debounce_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct button_input *btn = CONTAINER_OF(dwork, struct button_input, debounce_work);
+	uint32_t edge = drain_edges(btn);
+	bool pressed = gpio_pin_get_dt(btn->spec) > 0;
+
+	if (pressed == btn->pressed) {
+		/* Bounced back to where it was */
+		return;
+	}
+	btn->pressed = pressed;
+
+	if (pressed) {
+		btn->press_cycles = edge;
+		btn->long_fired = false;
+		k_work_reschedule_for_queue(&input_workq, &btn->long_work,
+					    K_MSEC(CONFIG_APP_INPUT_LONG_PRESS_MS));
+		btn->handler(btn, BUTTON_EVT_PRESS, edge);
+		return;
+	}
+
+	k_work_cancel_delayable(&btn->long_work);
+	btn->handler(btn, BUTTON_EVT_RELEASE, edge);
+	if (btn->long_fired) {
+		return;
+	}
+
+	if (btn->click_pending) {
+		btn->click_pending = false;
+		k_work_cancel_delayable(&btn->click_work);
+		btn->handler(btn, BUTTON_EVT_DOUBLE_CLICK, btn->press_cycles);
+	} else {
+		btn->click_pending = true;
+		k_work_reschedule_for_queue(&input_workq, &btn->click_work,
+					    K_MSEC(CONFIG_APP_INPUT_DOUBLE_CLICK_MS));
+	}
+}
+
+static void long_press_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct button_input *btn = CONTAINER_OF(dwork, struct button_input, long_work);
+
+	if (btn->pressed) {
+		btn->long_fired = true;
+		btn->click_pending = false;
+		k_work_cancel_delayable(&btn->click_work);
+		btn->handler(btn, BUTTON_EVT_LONG_PRESS, btn->press_cycles);
+	}
+}
+
+static void click_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct button_input *btn = CONTAINER_OF(dwork, struct button_input, click_work);
+
+	/* No second press inside the window, unless one is being held now */
+	if (btn->click_pending && !btn->pressed) {
+		btn->click_pending = false;
+		btn->handler(btn, BUTTON_EVT_CLICK, btn->press_cycles);
+	}
+}
+
+int button_input_init(struct button_input *btn, const struct gpio_dt_spec *spec,
+		      button_handler_t handler, void *user_data)
+{
+	int ret;
+
+	if (!gpio_is_ready_dt(spec)) {
+		return -ENODEV;
+	}
+
+	btn->spec = spec;
+	btn->handler = handler;
+	btn->user_data = user_data;
+	atomic_clear(&btn->head);
+	atomic_clear(&btn->tail);
+	atomic_clear(&btn->overflows);
+	btn->bounces = 0;
+	btn->long_fired = false;
+	btn->click_pending = false;
+	k_work_init_delayable(&btn->debounce_work, debounce_handler);
+	k_work_init_delayable(&btn->long_work, long_press_handler);
+	k_work_init_delayable(&btn->click_work, click_handler);
+
+	ret = gpio_pin_configure_dt(spec, GPIO_INPUT);
+	if (ret < 0) {
+		return ret;
+	}
+	btn->pressed = gpio_pin_get_dt(spec) > 0;
+
+	gpio_init_callback(&btn->cb, button_isr, BIT(spec->pin));
+	ret = gpio_add_callback(spec->port, &btn->cb);
+	if (ret < 0) {
+		return ret;
+	}
+	return gpio_pin_interrupt_configure_dt(spec, GPIO_INT_EDGE_BOTH);
+}
+
+uint32_t button_input_overflows(const struct button_input *btn)
+{
+	return atomic_get(&btn->overflows);
+}
+
+uint32_t button_input_bounces(const struct button_input *btn)
+{
+	return btn->bounces;
+}
+
+const char *button_evt_str(enum button_evt evt)
+{
+	static const char *const names[] = {
+		[BUTTON_EVT_PRESS] = "press",
+		[BUTTON_EVT_RELEASE] = "release",
+		[BUTTON_EVT_CLICK] = "click",
+		[BUTTON_EVT_DOUBLE_CLICK] = "double click",
+		[BUTTON_EVT_LONG_PRESS] = "long press",
+	};
+
+	return evt < ARRAY_SIZE(names) ? names[evt] : "?";
+}
+
+static int input_workq_init(void)
+{
+	k_work_queue_start(&input_workq, input_workq_stack,
+			   K_THREAD_STACK_SIZEOF(input_workq_stack),
+			   CONFIG_APP_INPUT_WORKQ_PRIORITY, NULL);
+	k_thread_name_set(&input_workq.thread, "input_workq");
+	return 0;
+}
+
+SYS_INIT(input_workq_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
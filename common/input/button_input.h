@@ -0,0 +1,67 @@
+/*
+ * Button input events
+ *
+ * The GPIO interrupt only timestamps the edge, pushes it into a per-button
+ * lock-free ring and (re)arms the debounce work item; nothing else runs in
+ * ISR context. Debouncing, press/release, click, double click and long
+ * press detection and the application handler all run on the input work
+ * queue, so no polling is needed.
+ */
+
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/atomic.h>
+
+enum button_evt {
+	BUTTON_EVT_PRESS,
+	BUTTON_EVT_RELEASE,
+	BUTTON_EVT_CLICK,
+	BUTTON_EVT_DOUBLE_CLICK,
+	BUTTON_EVT_LONG_PRESS,
+};
+
+struct button_input;
+
+/*
+ * Runs on the input work queue. edge_cycles is the k_cycle_get_32() stamp
+ * taken in the ISR for the first edge of the debounced transition that
+ * caused the event.
+ */
+typedef void (*button_handler_t)(struct button_input *btn, enum button_evt evt,
+				 uint32_t edge_cycles);
+
+struct button_input {
+	const struct gpio_dt_spec *spec;
+	button_handler_t handler;
+	void *user_data;
+
+	/* Private */
+	struct gpio_callback cb;
+	uint32_t edges[CONFIG_APP_INPUT_EDGE_QUEUE_LEN];
+	atomic_t head;
+	atomic_t tail;
+	atomic_t overflows;
+	struct k_work_delayable debounce_work;
+	struct k_work_delayable long_work;
+	struct k_work_delayable click_work;
+	uint32_t press_cycles;
+	uint32_t bounces;
+	bool pressed;
+	bool long_fired;
+	bool click_pending;
+};
+
+/* Configure the pin as an interrupt driven input and start reporting events */
+int button_input_init(struct button_input *btn, const struct gpio_dt_spec *spec,
+		      button_handler_t handler, void *user_data);
+
+/* Edges dropped because the ring was full, and extra edges seen while bouncing */
+uint32_t button_input_overflows(const struct button_input *btn);
+uint32_t button_input_bounces(const struct button_input *btn);
+
+const char *button_evt_str(enum button_evt evt);
+
+#endif /* BUTTON_INPUT_H */
@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+"""Generate the gamma correction table used by led_fade.
+
+Maps a perceptual brightness level (0-255) to a 16 bit duty fraction:
+lut[i] = round(65535 * (i / 255) ** gamma).
+"""
+
+import argparse
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--gamma", type=float, default=2.2)
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    values = [round(65535 * (i / 255) ** args.gamma) for i in range(256)]
+    rows = [", ".join("%5d" % v for v in values[i:i + 8]) for i in range(0, 256, 8)]
+
+    with open(args.output, "w") as out:
+        out.write("/* Generated by gen_gamma_lut.py, gamma %.2f. Do not edit. */\n\n" % args.gamma)
+        out.write("#include <stdint.h>\n\n")
+        out.write("#define LED_FADE_GAMMA_LUT_SIZE 256\n\n")
+        out.write("static const uint16_t led_fade_gamma_lut[LED_FADE_GAMMA_LUT_SIZE] = {\n")
+        out.write("".join("\t%s,\n" % row for row in rows))
+        out.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+/*
+ * Gamma-corrected PWM fade engine
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/spinlock.h>
+#include <errno.h>
+
+#include "led_fade.h"
+#include "gamma_lut.h"
+
+#define FADE_TICK_MS	(MSEC_PER_SEC / CONFIG_APP_FADE_UPDATE_HZ)
+
+static struct led_fade_channel *channels[CONFIG_APP_FADE_MAX_CHANNELS];
+static size_t channel_count;
+static struct k_spinlock fade_lock;
+static bool ticking;
+
+static void fade_work_handler(struct k_work *work);
+static K_WORK_DEFINE(fade_work, fade_work_handler);
+
+static void fade_timer_expiry(struct k_timer *timer)
+{
+	k_work_submit(&fade_work);
+}
+
+static K_TIMER_DEFINE(fade_timer, fade_timer_expiry, NULL);
+
+static int fade_apply(const struct led_fade_channel *ch, uint8_t level)
+{
+	/* The table is scaled to 65535, so level 255 gives a full period */
+	uint32_t pulse = ((uint64_t)ch->period_cycles * led_fade_gamma_lut[level]) / 65535U;
+
+	return pwm_set_cycles(ch->pwm->dev, ch->pwm->channel, ch->period_cycles, pulse,
+			      ch->pwm->flags);
+}
+
+static void fade_work_handler(struct k_work *work)
+{
+	struct {
+		struct led_fade_channel *ch;
+		uint8_t level;
+		bool finished;
+	} updates[CONFIG_APP_FADE_MAX_CHANNELS];
+	size_t nupdates = 0;
+	bool active = false;
+	k_spinlock_key_t key = k_spin_lock(&fade_lock);
+
+	for (size_t i = 0; i < channel_count; i++) {
+		struct led_fade_channel *ch = channels[i];
+
+		if (ch->ticks_left == 0) {
+			continue;
+		}
+		if (--ch->ticks_left == 0) {
+			ch->level_q8 = ch->target << 8;
+		} else {
+			ch->level_q8 += ch->step_q8;
+			active = true;
+		}
+		updates[nupdates].ch = ch;
+		updates[nupdates].level = ch->level_q8 >> 8;
+		updates[nupdates].finished = ch->ticks_left == 0;
+		nupdates++;
+	}
+
+	if (!active) {
+		k_timer_stop(&fade_timer);
+		ticking = false;
+	}
+	k_spin_unlock(&fade_lock, key);
+
+	/* PWM drivers may sleep, and callbacks may start the next ramp */
+	for (size_t i = 0; i < nupdates; i++) {
+		struct led_fade_channel *ch = updates[i].ch;
+
+		fade_apply(ch, updates[i].level);
+		if (updates[i].finished && ch->done != NULL) {
+			ch->done(ch);
+		}
+	}
+}
+
+int led_fade_channel_init(struct led_fade_channel *ch, const struct pwm_dt_spec *pwm,
+			  led_fade_done_t done)
+{
+	uint64_t cycles_per_sec;
+	uint32_t hz = CONFIG_APP_FADE_PWM_HZ;
+	k_spinlock_key_t key;
+	int ret;
+
+	if (!pwm_is_ready_dt(pwm)) {
+		return -ENODEV;
+	}
+	ret = pwm_get_cycles_per_sec(pwm->dev, pwm->channel, &cycles_per_sec);
+	if (ret < 0) {
+		return ret;
+	}
+
+	*ch = (struct led_fade_channel){ .pwm = pwm, .done = done };
+
+	/* Calibrate once: raise the frequency until the period is accepted */
+	do {
+		ch->period_cycles = cycles_per_sec / hz;
+		if (ch->period_cycles < 256) {
+			return -ENOTSUP;
+		}
+		ret = fade_apply(ch, 0);
+		hz *= 2U;
+	} while (ret != 0);
+
+	key = k_spin_lock(&fade_lock);
+	if (channel_count == ARRAY_SIZE(channels)) {
+		ret = -ENOMEM;
+	} else {
+		channels[channel_count++] = ch;
+	}
+	k_spin_unlock(&fade_lock, key);
+	return ret;
+}
+
+int led_fade_to(struct led_fade_channel *ch, uint8_t level, uint32_t duration_ms)
+{
+	uint32_t ticks = duration_ms / FADE_TICK_MS;
+	k_spinlock_key_t key = k_spin_lock(&fade_lock);
+
+	ch->target = level;
+	if (ticks == 0) {
+		ch->ticks_left = 0;
+		ch->level_q8 = level << 8;
+		k_spin_unlock(&fade_lock, key);
+		return fade_apply(ch, level);
+	}
+
+	ch->step_q8 = ((level << 8) - ch->level_q8) / (int32_t)ticks;
+	ch->ticks_left = ticks;
+	if (!ticking) {
+		ticking = true;
+		k_timer_start(&fade_timer, K_MSEC(FADE_TICK_MS), K_MSEC(FADE_TICK_MS));
+	}
+	k_spin_unlock(&fade_lock, key);
+	return 0;
+}
+
+uint8_t led_fade_level(const struct led_fade_channel *ch)
+{
+	return ch->level_q8 >> 8;
+}
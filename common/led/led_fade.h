@@ -0,0 +1,49 @@
+/*
+ * Gamma-corrected PWM fade engine
+ *
+ * Channels take perceptual brightness levels (0-255) that are mapped
+ * through a build-time generated gamma table. Ramps on every registered
+ * channel are advanced together by one work item, kicked by a k_timer at
+ * CONFIG_APP_FADE_UPDATE_HZ while any ramp is active, so any number of
+ * LEDs dim smoothly without a thread per channel.
+ */
+
+#ifndef LED_FADE_H
+#define LED_FADE_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/pwm.h>
+
+struct led_fade_channel;
+
+/* Called from the fade work item when a ramp reaches its target */
+typedef void (*led_fade_done_t)(struct led_fade_channel *ch);
+
+struct led_fade_channel {
+	const struct pwm_dt_spec *pwm;
+	led_fade_done_t done;
+
+	/* Calibration, probed once at init */
+	uint32_t period_cycles;
+
+	/* Ramp state, level in 8.8 fixed point */
+	int32_t level_q8;
+	int32_t step_q8;
+	uint32_t ticks_left;
+	uint8_t target;
+};
+
+/*
+ * Probe and cache the PWM period for the channel, turn it off and register
+ * it with the engine. done may be NULL.
+ */
+int led_fade_channel_init(struct led_fade_channel *ch, const struct pwm_dt_spec *pwm,
+			  led_fade_done_t done);
+
+/* Ramp to level over duration_ms, 0 sets the level immediately */
+int led_fade_to(struct led_fade_channel *ch, uint8_t level, uint32_t duration_ms);
+
+/* Current perceptual level */
+uint8_t led_fade_level(const struct led_fade_channel *ch);
+
+#endif /* LED_FADE_H */
@@ -0,0 +1,121 @@
+/*
+ * Port-batched LED patterns
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <errno.h>
+
+#include "led_pattern.h"
+
+int led_group_init(struct led_group *group, const struct gpio_dt_spec *leds, size_t count)
+{
+	if (count > LED_GROUP_MAX_LEDS) {
+		return -EINVAL;
+	}
+
+	group->leds = leds;
+	group->count = count;
+	group->nports = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		size_t p;
+		int ret;
+
+		if (!gpio_is_ready_dt(&leds[i])) {
+			return -ENODEV;
+		}
+		ret = gpio_pin_configure_dt(&leds[i], GPIO_OUTPUT_INACTIVE);
+		if (ret < 0) {
+			return ret;
+		}
+
+		for (p = 0; p < group->nports; p++) {
+			if (group->ports[p] == leds[i].port) {
+				break;
+			}
+		}
+		if (p == group->nports) {
+			if (p == LED_GROUP_MAX_PORTS) {
+				return -ENOMEM;
+			}
+			group->ports[group->nports++] = leds[i].port;
+		}
+		group->led_port[i] = p;
+	}
+	return 0;
+}
+
+int led_group_apply(const struct led_group *group, const struct led_step *step)
+{
+	gpio_port_pins_t set_mask[LED_GROUP_MAX_PORTS] = {0};
+	gpio_port_value_t set_value[LED_GROUP_MAX_PORTS] = {0};
+	gpio_port_pins_t toggle[LED_GROUP_MAX_PORTS] = {0};
+	int ret;
+
+	for (size_t i = 0; i < group->count; i++) {
+		const struct gpio_dt_spec *led = &group->leds[i];
+		gpio_port_pins_t bit = BIT(led->pin);
+		uint8_t p = group->led_port[i];
+
+		if (step->mask & BIT(i)) {
+			bool on = step->value & BIT(i);
+			bool active_low = led->dt_flags & GPIO_ACTIVE_LOW;
+
+			set_mask[p] |= bit;
+			if (on != active_low) {
+				set_value[p] |= bit;
+			}
+		}
+		if (step->toggle & BIT(i)) {
+			toggle[p] |= bit;
+		}
+	}
+
+	for (size_t p = 0; p < group->nports; p++) {
+		if (set_mask[p]) {
+			ret = gpio_port_set_masked_raw(group->ports[p], set_mask[p], set_value[p]);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+		if (toggle[p]) {
+			ret = gpio_port_toggle_bits(group->ports[p], toggle[p]);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+	return 0;
+}
+
+static void led_player_expiry(struct k_timer *timer)
+{
+	struct led_player *player = CONTAINER_OF(timer, struct led_player, timer);
+	const struct led_step *step = &player->steps[player->next];
+
+	led_group_apply(player->group, step);
+	player->next = (player->next + 1) % player->count;
+	k_timer_start(&player->timer, K_MSEC(MAX(step->hold_ms, 1)), K_NO_WAIT);
+}
+
+int led_player_start(struct led_player *player, const struct led_group *group,
+		     const struct led_step *steps, size_t count)
+{
+	if (count == 0) {
+		return -EINVAL;
+	}
+
+	player->group = group;
+	player->steps = steps;
+	player->count = count;
+	player->next = 0;
+	k_timer_init(&player->timer, led_player_expiry, NULL);
+	k_timer_start(&player->timer, K_NO_WAIT, K_NO_WAIT);
+	return 0;
+}
+
+void led_player_stop(struct led_player *player)
+{
+	k_timer_stop(&player->timer);
+}
@@ -0,0 +1,74 @@
+/*
+ * Port-batched LED patterns
+ *
+ * LEDs of a group are bucketed by GPIO port when the group is set up. A
+ * pattern step is then applied with one gpio_port_set_masked_raw() and one
+ * gpio_port_toggle_bits() call per port, so LEDs sharing a port change in
+ * the same register write instead of skewing apart over separate
+ * gpio_pin_*_dt() round-trips.
+ *
+ * Steps address LEDs by their index in the group (bit i = leds[i]) with
+ * logical levels; GPIO_ACTIVE_LOW pins are inverted for the raw writes.
+ */
+
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+
+#define LED_GROUP_MAX_LEDS	8
+#define LED_GROUP_MAX_PORTS	4
+
+struct led_step {
+	/* LEDs forced to the logical levels in value */
+	uint8_t mask;
+	uint8_t value;
+	/* LEDs toggled after mask/value is applied */
+	uint8_t toggle;
+	/* Time to hold this step when played back */
+	uint16_t hold_ms;
+};
+
+#define LED_STEP_SET(_mask, _value, _hold_ms) \
+	{ .mask = (_mask), .value = (_value), .hold_ms = (_hold_ms) }
+
+#define LED_STEP_TOGGLE(_bits, _hold_ms) \
+	{ .toggle = (_bits), .hold_ms = (_hold_ms) }
+
+struct led_group {
+	const struct gpio_dt_spec *leds;
+	size_t count;
+	const struct device *ports[LED_GROUP_MAX_PORTS];
+	size_t nports;
+	uint8_t led_port[LED_GROUP_MAX_LEDS];
+};
+
+/*
+ * Configure every LED as an inactive output and bucket the LEDs by port.
+ * Returns -ENODEV if a port is not ready, -EINVAL for too many LEDs and
+ * -ENOMEM if they span more than LED_GROUP_MAX_PORTS ports.
+ */
+int led_group_init(struct led_group *group, const struct gpio_dt_spec *leds, size_t count);
+
+/* Apply one step, one driver call per port and operation */
+int led_group_apply(const struct led_group *group, const struct led_step *step);
+
+/*
+ * Loop a pattern from k_timer expiries: each step is applied in timer
+ * context and holds for its hold_ms, no thread is involved.
+ */
+struct led_player {
+	const struct led_group *group;
+	const struct led_step *steps;
+	size_t count;
+	size_t next;
+	struct k_timer timer;
+};
+
+int led_player_start(struct led_player *player, const struct led_group *group,
+		     const struct led_step *steps, size_t count);
+
+void led_player_stop(struct led_player *player);
+
+#endif /* LED_PATTERN_H */
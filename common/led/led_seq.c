@@ -0,0 +1,213 @@
+/*
+ * Hardware-timed LED sequencer
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/spinlock.h>
+#include <errno.h>
+
+#include "led_seq.h"
+
+/* Longest period probed, shorter ones are tried by halving */
+#define LED_SEQ_PROBE_PERIOD_NS	PWM_SEC(4)
+
+static void seq_off(struct led_seq *seq)
+{
+	pwm_set_dt(seq->pwm, LED_SEQ_LEVEL_PERIOD_NS, 0);
+}
+
+/*
+ * A single step played forever needs no timer, the PWM keeps generating it
+ * until the pattern is replaced. Called with the lock held.
+ */
+static bool seq_free_running(const struct led_seq *seq)
+{
+	return seq->cur->count == 1 && seq->cur->repeat == 0;
+}
+
+/* Called with the lock held */
+static void seq_apply(struct led_seq *seq)
+{
+	const struct led_seq_step *step = &seq->cur->steps[seq->step];
+
+	pwm_set_dt(seq->pwm, step->period_ns, step->pulse_ns);
+	/* With patterns queued behind it, a free running step still plays one period */
+	if (step->hold_ms && (!seq_free_running(seq) || seq->q_count > 0)) {
+		k_timer_start(&seq->timer, K_MSEC(step->hold_ms), K_NO_WAIT);
+	}
+}
+
+/* Called with the lock held, starts the next queued pattern or goes idle */
+static void seq_load_next(struct led_seq *seq)
+{
+	seq->step = 0;
+	seq->played = 0;
+	if (seq->q_count == 0) {
+		seq->cur = NULL;
+		seq_off(seq);
+		return;
+	}
+	seq->cur = seq->queue[seq->q_head];
+	seq->q_head = (seq->q_head + 1) % LED_SEQ_QUEUE_LEN;
+	seq->q_count--;
+	seq_apply(seq);
+}
+
+static void seq_timer_expiry(struct k_timer *timer)
+{
+	struct led_seq *seq = CONTAINER_OF(timer, struct led_seq, timer);
+	k_spinlock_key_t key = k_spin_lock(&seq->lock);
+
+	if (seq->cur == NULL) {
+		goto out;
+	}
+	if (++seq->step == seq->cur->count) {
+		seq->step = 0;
+		if (seq->cur->repeat ? ++seq->played >= seq->cur->repeat : seq_free_running(seq)) {
+			seq_load_next(seq);
+			goto out;
+		}
+	}
+	if (seq->cur->count == 1) {
+		/* The PWM keeps generating the step, only count the period */
+		k_timer_start(&seq->timer, K_MSEC(seq->cur->steps[0].hold_ms), K_NO_WAIT);
+	} else {
+		seq_apply(seq);
+	}
+out:
+	k_spin_unlock(&seq->lock, key);
+}
+
+int led_seq_init(struct led_seq *seq, const struct pwm_dt_spec *pwm)
+{
+	uint32_t period = LED_SEQ_PROBE_PERIOD_NS;
+
+	if (!pwm_is_ready_dt(pwm)) {
+		return -ENODEV;
+	}
+
+	*seq = (struct led_seq){ .pwm = pwm };
+	k_timer_init(&seq->timer, seq_timer_expiry, NULL);
+
+	/* Same calibration as the PWM blinky: halve until the period is accepted */
+	while (pwm_set_dt(pwm, period, 0) != 0) {
+		period /= 2U;
+		if (period < LED_SEQ_LEVEL_PERIOD_NS) {
+			return -ENOTSUP;
+		}
+	}
+	seq->max_period_ns = period;
+	seq_off(seq);
+	return 0;
+}
+
+int led_seq_compile_blink(const struct led_seq *seq, struct led_seq_step *buf, size_t len,
+			  uint32_t on_ms, uint32_t off_ms)
+{
+	uint64_t period = PWM_MSEC((uint64_t)on_ms + off_ms);
+
+	if (period <= seq->max_period_ns) {
+		if (len < 1) {
+			return -ENOMEM;
+		}
+		/* Held one period so repeat counting and the queue advance */
+		buf[0] = (struct led_seq_step){
+			.period_ns = period,
+			.pulse_ns = PWM_MSEC(on_ms),
+			.hold_ms = on_ms + off_ms,
+		};
+		return 1;
+	}
+
+	if (len < 2) {
+		return -ENOMEM;
+	}
+	buf[0] = (struct led_seq_step){
+		.period_ns = LED_SEQ_LEVEL_PERIOD_NS,
+		.pulse_ns = LED_SEQ_LEVEL_PERIOD_NS,
+		.hold_ms = on_ms,
+	};
+	buf[1] = (struct led_seq_step){
+		.period_ns = LED_SEQ_LEVEL_PERIOD_NS,
+		.pulse_ns = 0,
+		.hold_ms = off_ms,
+	};
+	return 2;
+}
+
+int led_seq_compile_levels(struct led_seq_step *buf, size_t len, const uint8_t *levels,
+			   size_t count, uint32_t step_ms)
+{
+	if (len < count) {
+		return -ENOMEM;
+	}
+	for (size_t i = 0; i < count; i++) {
+		buf[i] = (struct led_seq_step){
+			.period_ns = LED_SEQ_LEVEL_PERIOD_NS,
+			.pulse_ns = (uint64_t)LED_SEQ_LEVEL_PERIOD_NS * levels[i] / 255U,
+			.hold_ms = step_ms,
+		};
+	}
+	return count;
+}
+
+int led_seq_start(struct led_seq *seq, const struct led_seq_pattern *pattern)
+{
+	k_spinlock_key_t key;
+
+	if (pattern->count == 0) {
+		return -EINVAL;
+	}
+
+	k_timer_stop(&seq->timer);
+	key = k_spin_lock(&seq->lock);
+	seq->queue[seq->q_head] = pattern;
+	seq->q_count = 1;
+	seq_load_next(seq);
+	k_spin_unlock(&seq->lock, key);
+	return 0;
+}
+
+int led_seq_queue(struct led_seq *seq, const struct led_seq_pattern *pattern)
+{
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	if (pattern->count == 0) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&seq->lock);
+	if (seq->q_count == LED_SEQ_QUEUE_LEN) {
+		ret = -ENOMEM;
+	} else {
+		seq->queue[(seq->q_head + seq->q_count) % LED_SEQ_QUEUE_LEN] = pattern;
+		seq->q_count++;
+		if (seq->cur == NULL || seq_free_running(seq)) {
+			seq_load_next(seq);
+		}
+	}
+	k_spin_unlock(&seq->lock, key);
+	return ret;
+}
+
+void led_seq_stop(struct led_seq *seq)
+{
+	k_spinlock_key_t key;
+
+	k_timer_stop(&seq->timer);
+	key = k_spin_lock(&seq->lock);
+	seq->q_count = 0;
+	seq_load_next(seq);
+	k_spin_unlock(&seq->lock, key);
+}
+
+bool led_seq_is_running(struct led_seq *seq)
+{
+	k_spinlock_key_t key = k_spin_lock(&seq->lock);
+	bool running = seq->cur != NULL;
+
+	k_spin_unlock(&seq->lock, key);
+	return running;
+}
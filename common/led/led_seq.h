@@ -0,0 +1,83 @@
+/*
+ * Hardware-timed LED sequencer
+ *
+ * Blink and brightness patterns are compiled into buffers of PWM steps and
+ * played back on a pwm_dt_spec. A blink whose period the PWM can generate
+ * compiles to a single step the peripheral repeats on its own; played
+ * forever it needs no CPU at all, with a repeat count the CPU only wakes
+ * once per period to count. Longer periods and
+ * brightness ramps fall back to one k_timer expiry per step, with no
+ * thread involved.
+ *
+ * Steps are applied from timer (ISR) context, which the PWM drivers in
+ * use (STM32, nRF) support.
+ */
+
+#ifndef LED_SEQ_H
+#define LED_SEQ_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/pwm.h>
+
+#define LED_SEQ_QUEUE_LEN	4
+
+/* PWM period used for brightness levels and software timed steps */
+#define LED_SEQ_LEVEL_PERIOD_NS	PWM_MSEC(1)
+
+struct led_seq_step {
+	uint32_t period_ns;
+	uint32_t pulse_ns;
+	/* Time before the next step, 0 holds this step until stopped */
+	uint32_t hold_ms;
+};
+
+struct led_seq_pattern {
+	const struct led_seq_step *steps;
+	size_t count;
+	/* Number of times to play the steps, 0 repeats forever */
+	uint16_t repeat;
+};
+
+struct led_seq {
+	const struct pwm_dt_spec *pwm;
+	uint32_t max_period_ns;
+	struct k_timer timer;
+	struct k_spinlock lock;
+	const struct led_seq_pattern *queue[LED_SEQ_QUEUE_LEN];
+	uint8_t q_head;
+	uint8_t q_count;
+	const struct led_seq_pattern *cur;
+	size_t step;
+	uint16_t played;
+};
+
+/* Probe the longest period the PWM supports and turn the LED off */
+int led_seq_init(struct led_seq *seq, const struct pwm_dt_spec *pwm);
+
+/*
+ * Compile a blink into buf. Returns the number of steps written: 1 when the
+ * PWM can generate the period itself, 2 (on/off timed steps) otherwise, or
+ * -ENOMEM if buf is too small.
+ */
+int led_seq_compile_blink(const struct led_seq *seq, struct led_seq_step *buf, size_t len,
+			  uint32_t on_ms, uint32_t off_ms);
+
+/* Compile brightness levels (0-255), each held step_ms, returns steps written */
+int led_seq_compile_levels(struct led_seq_step *buf, size_t len, const uint8_t *levels,
+			   size_t count, uint32_t step_ms);
+
+/* Play a pattern now, dropping the current one and anything queued */
+int led_seq_start(struct led_seq *seq, const struct led_seq_pattern *pattern);
+
+/*
+ * Play a pattern after the queued ones finish. Starts it at once if idle or
+ * if the current pattern is a single step played forever.
+ */
+int led_seq_queue(struct led_seq *seq, const struct led_seq_pattern *pattern);
+
+/* Stop playback, drop the queue and turn the LED off */
+void led_seq_stop(struct led_seq *seq);
+
+bool led_seq_is_running(struct led_seq *seq);
+
+#endif /* LED_SEQ_H */
@@ -0,0 +1,161 @@
+/**
+ * @file uart_cmd.c
+ * @brief Extensible UART command table with O(1) lookup.
+ *
+ * The uart_cmd section is only known after linking, so the lookup structure
+ * is an open-addressing FNV-1a hash index built once at boot. Dispatch cost
+ * does not grow with the number of commands as long as the index stays at
+ * most half full. Built-in command output goes through the buffered
+ * transmit path (uart_tx).
+ */
+
+#include "uart_cmd.h"
+#include "uart_tx.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#define INDEX_SIZE CONFIG_APP_UART_CMD_INDEX_SIZE
+#define INDEX_MASK (INDEX_SIZE - 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(INDEX_SIZE), "CONFIG_APP_UART_CMD_INDEX_SIZE must be a power of two");
+BUILD_ASSERT(INDEX_SIZE <= UINT16_MAX, "CONFIG_APP_UART_CMD_INDEX_SIZE too large");
+
+/* Section index + 1 of the command in each slot, 0 marks an empty slot */
+static uint16_t cmd_index[INDEX_SIZE];
+static uint32_t cmd_misses;
+
+static uint32_t cmd_hash(const char *name)
+{
+	uint32_t hash = 2166136261U;
+
+	while(*name != '\0'){
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+const struct uart_cmd *uart_cmd_find(const char *name)
+{
+	const struct uart_cmd *cmd;
+	uint32_t slot = cmd_hash(name) & INDEX_MASK;
+
+	while(cmd_index[slot] != 0){
+		STRUCT_SECTION_GET(uart_cmd, cmd_index[slot] - 1, &cmd);
+		if(strcmp(cmd->name, name) == 0){
+			return cmd;
+		}
+		slot = (slot + 1) & INDEX_MASK;
+	}
+	return NULL;
+}
+
+/* Split on spaces in place, returns the number of tokens */
+static size_t cmd_tokenize(char *line, char **argv, size_t max)
+{
+	size_t argc = 0;
+
+	while(*line != '\0' && argc < max){
+		while(*line == ' '){
+			*line++ = '\0';
+		}
+		if(*line == '\0'){
+			break;
+		}
+		argv[argc++] = line;
+		while(*line != ' ' && *line != '\0'){
+			line++;
+		}
+	}
+	return argc;
+}
+
+int uart_cmd_dispatch(char *line)
+{
+	/* One extra slot so too many arguments are detected instead of silently dropped */
+	char *argv[CONFIG_APP_UART_CMD_MAX_ARGS + 2];
+	size_t argc = cmd_tokenize(line, argv, ARRAY_SIZE(argv));
+	const struct uart_cmd *cmd;
+
+	if(argc == 0){
+		return 0;
+	}
+
+	cmd = uart_cmd_find(argv[0]);
+	if(cmd == NULL){
+		cmd_misses++;
+		return -ENOENT;
+	}
+
+	if(argc - 1 < cmd->min_args || argc - 1 > cmd->max_args){
+		cmd->stats->arg_errors++;
+		return -EINVAL;
+	}
+
+	cmd->stats->hits++;
+	return cmd->handler(argc, argv);
+}
+
+uint32_t uart_cmd_misses(void)
+{
+	return cmd_misses;
+}
+
+static int cmd_help(size_t argc, char **argv)
+{
+	STRUCT_SECTION_FOREACH(uart_cmd, cmd){
+		uart_tx_printf("%-10s %s\r\n", cmd->name, cmd->help);
+	}
+	return 0;
+}
+
+UART_CMD_DEFINE(help, "HELP", 0, 0, cmd_help, "List commands");
+
+static int cmd_stats(size_t argc, char **argv)
+{
+	STRUCT_SECTION_FOREACH(uart_cmd, cmd){
+		uart_tx_printf("%-10s hits %u arg errors %u\r\n", cmd->name, cmd->stats->hits,
+			       cmd->stats->arg_errors);
+	}
+	uart_tx_printf("unknown    %u\r\n", cmd_misses);
+	return 0;
+}
+
+UART_CMD_DEFINE(stats, "STATS", 0, 0, cmd_stats, "Show command hit/miss statistics");
+
+/* Build the hash index over the linker-collected command table */
+static int uart_cmd_init(void)
+{
+	int count;
+
+	STRUCT_SECTION_COUNT(uart_cmd, &count);
+	if(count >= INDEX_SIZE){
+		printk("uart_cmd: %d commands do not fit %d index slots\n", count, INDEX_SIZE);
+		return -ENOMEM;
+	}
+
+	for(int i = 0; i < count; i++){
+		const struct uart_cmd *cmd;
+		uint32_t slot;
+
+		STRUCT_SECTION_GET(uart_cmd, i, &cmd);
+		if(uart_cmd_find(cmd->name) != NULL){
+			printk("uart_cmd: duplicate command %s\n", cmd->name);
+			continue;
+		}
+
+		slot = cmd_hash(cmd->name) & INDEX_MASK;
+		while(cmd_index[slot] != 0){
+			slot = (slot + 1) & INDEX_MASK;
+		}
+		cmd_index[slot] = i + 1;
+	}
+	return 0;
+}
+
+SYS_INIT(uart_cmd_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,71 @@
+/**
+ * @file uart_cmd.h
+ * @brief Extensible UART command table.
+ *
+ * Commands are declared anywhere in the application with UART_CMD_DEFINE()
+ * and collected by the linker into the uart_cmd iterable section. At boot a
+ * hash index is built over the section, so resolving a command costs one hash
+ * of the keyword and normally one string compare, however many commands exist.
+ */
+
+#ifndef UART_CMD_H
+#define UART_CMD_H
+
+#include <zephyr/sys/iterable_sections.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct uart_cmd_stats {
+	uint32_t hits;       // Successful dispatches
+	uint32_t arg_errors; // Rejected for a wrong argument count
+};
+
+/* Command handler, argv[0] is the command keyword */
+typedef int (*uart_cmd_handler_t)(size_t argc, char **argv);
+
+struct uart_cmd {
+	const char *name;
+	const char *help;
+	uart_cmd_handler_t handler;
+	struct uart_cmd_stats *stats;
+	uint8_t min_args;
+	uint8_t max_args;
+};
+
+/**
+ * @brief Declare a UART command.
+ *
+ * Input: _id       Unique C identifier for the entry.
+ *        _name     Command keyword, e.g. "LED".
+ *        _min/_max Accepted number of arguments after the keyword.
+ *        _handler  Handler, called from the line receive thread.
+ *        _help     One-line usage text shown by HELP.
+ */
+#define UART_CMD_DEFINE(_id, _name, _min, _max, _handler, _help)			\
+	static struct uart_cmd_stats uart_cmd_stats_##_id;				\
+	static const STRUCT_SECTION_ITERABLE(uart_cmd, uart_cmd_##_id) = {		\
+		.name = _name,								\
+		.help = _help,								\
+		.handler = _handler,							\
+		.stats = &uart_cmd_stats_##_id,						\
+		.min_args = _min,							\
+		.max_args = _max,							\
+	}
+
+/**
+ * @brief Tokenize a line in place and run the matching command.
+ *
+ * Returns: handler result on dispatch
+ *          0        Empty line
+ *         -ENOENT   Unknown command
+ *         -EINVAL   Wrong number of arguments
+ */
+int uart_cmd_dispatch(char *line);
+
+/* Look up a command by keyword, NULL if unknown */
+const struct uart_cmd *uart_cmd_find(const char *name);
+
+/* Number of lines that did not resolve to a command */
+uint32_t uart_cmd_misses(void);
+
+#endif
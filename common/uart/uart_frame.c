@@ -0,0 +1,103 @@
+/**
+ * @file uart_frame.c
+ * @brief COBS framing with CRC16 for binary UART protocols.
+ */
+
+#include "uart_frame.h"
+
+#include <zephyr/sys/crc.h>
+#include <errno.h>
+
+int uart_frame_encode(const uint8_t *payload, size_t len, uint8_t *out, size_t out_size)
+{
+	uint16_t crc = crc16_ccitt(UART_FRAME_CRC_SEED, payload, len);
+	const uint8_t crc_le[UART_FRAME_CRC_LEN] = { crc & 0xFF, crc >> 8 };
+	size_t code_pos = 0;
+	size_t out_len = 1;
+	uint8_t code = 1;
+
+	if(out_size < UART_FRAME_ENCODED_MAX(len)){
+		return -ENOMEM;
+	}
+
+	for(size_t i = 0; i < len + UART_FRAME_CRC_LEN; i++){
+		uint8_t byte = (i < len) ? payload[i] : crc_le[i - len];
+
+		if(byte != 0){
+			out[out_len++] = byte;
+			code++;
+		}
+		if(byte == 0 || code == 0xFF){
+			out[code_pos] = code;
+			code_pos = out_len++;
+			code = 1;
+		}
+	}
+	out[code_pos] = code;
+	out[out_len++] = UART_FRAME_DELIM;
+
+	return out_len;
+}
+
+/* COBS decode in place, the output never overtakes the input */
+static int cobs_decode(uint8_t *buf, size_t len)
+{
+	size_t rd = 0;
+	size_t wr = 0;
+
+	while(rd < len){
+		uint8_t code = buf[rd++];
+
+		if(code == 0 || rd + code - 1 > len){
+			return -EINVAL;
+		}
+		for(uint8_t i = 1; i < code; i++){
+			buf[wr++] = buf[rd++];
+		}
+		if(code != 0xFF && rd < len){
+			buf[wr++] = 0;
+		}
+	}
+	return wr;
+}
+
+void uart_frame_decoder_init(struct uart_frame_decoder *dec, uint8_t *buf, size_t size)
+{
+	*dec = (struct uart_frame_decoder){
+		.buf = buf,
+		.size = size,
+	};
+}
+
+void uart_frame_decoder_feed(struct uart_frame_decoder *dec, const uint8_t *data, size_t len,
+			     uart_frame_cb_t cb, void *user_data)
+{
+	for(size_t i = 0; i < len; i++){
+		if(data[i] != UART_FRAME_DELIM){
+			if(dec->len < dec->size){
+				dec->buf[dec->len++] = data[i];
+			}else{
+				dec->overflow = true;
+			}
+			continue;
+		}
+
+		/* Delimiter: decode and validate the collected frame */
+		int decoded = (dec->overflow || dec->len == 0) ? -EINVAL : cobs_decode(dec->buf, dec->len);
+
+		if(decoded < UART_FRAME_CRC_LEN){
+			dec->frame_errors += (dec->len > 0 || dec->overflow);
+		}else{
+			size_t payload_len = decoded - UART_FRAME_CRC_LEN;
+			uint16_t crc = dec->buf[payload_len] | (dec->buf[payload_len + 1] << 8);
+
+			if(crc16_ccitt(UART_FRAME_CRC_SEED, dec->buf, payload_len) == crc){
+				cb(dec->buf, payload_len, user_data);
+			}else{
+				dec->crc_errors++;
+			}
+		}
+		dec->len = 0;
+		dec->overflow = false;
+	}
+}
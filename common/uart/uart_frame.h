@@ -0,0 +1,54 @@
+/**
+ * @file uart_frame.h
+ * @brief COBS framing with CRC16 for binary UART protocols.
+ *
+ * On the wire a frame is COBS(payload || CRC16 little endian) followed by a
+ * single 0x00 delimiter, so a receiver can resynchronise on the next zero
+ * byte after any corruption. The CRC is Zephyr's crc16_ccitt() seeded with
+ * 0xFFFF over the payload.
+ */
+
+#ifndef UART_FRAME_H
+#define UART_FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define UART_FRAME_DELIM   0x00
+#define UART_FRAME_CRC_LEN 2
+#define UART_FRAME_CRC_SEED 0xFFFF
+
+/* Worst-case encoded size of a payload, including CRC, COBS overhead and delimiter */
+#define UART_FRAME_ENCODED_MAX(n) \
+	((n) + UART_FRAME_CRC_LEN + ((n) + UART_FRAME_CRC_LEN) / 254 + 2)
+
+/* Called with each decoded payload whose CRC matched, CRC stripped */
+typedef void (*uart_frame_cb_t)(uint8_t *payload, size_t len, void *user_data);
+
+/* Incremental decoder, collects encoded bytes until the delimiter */
+struct uart_frame_decoder {
+	uint8_t *buf;
+	size_t size;
+	size_t len;
+	bool overflow;
+	uint32_t crc_errors;
+	uint32_t frame_errors;
+};
+
+/**
+ * @brief Encode a payload into a complete frame.
+ *
+ * Returns: encoded length including the delimiter
+ *         -ENOMEM  out_size smaller than UART_FRAME_ENCODED_MAX(len)
+ */
+int uart_frame_encode(const uint8_t *payload, size_t len, uint8_t *out, size_t out_size);
+
+/* buf must hold UART_FRAME_ENCODED_MAX() of the largest expected payload */
+void uart_frame_decoder_init(struct uart_frame_decoder *dec, uint8_t *buf, size_t size);
+
+/* Feed received bytes, cb runs synchronously for every valid frame found */
+void uart_frame_decoder_feed(struct uart_frame_decoder *dec, const uint8_t *data, size_t len,
+			     uart_frame_cb_t cb, void *user_data);
+
+#endif
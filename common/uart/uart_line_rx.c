@@ -0,0 +1,255 @@
+/**
+ * @file uart_line_rx.c
+ * @brief Line-oriented UART reception shared by the uart samples.
+ *
+ * Async mode: the driver DMAs into CONFIG_APP_UART_RX_BUF_COUNT buffers managed
+ * by the Zephyr uart_async_rx helper. UART_RX_RDY only publishes the received
+ * region and wakes the thread, which parses the data in place and releases it.
+ *
+ * Interrupt mode: the RX interrupt reads the whole FIFO directly into claimed
+ * ring buffer space instead of one byte per call.
+ */
+
+#include "uart_line_rx.h"
+#include "uart_port.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/ring_buffer.h>
+#if defined(CONFIG_APP_UART_RX_ASYNC)
+#include <zephyr/drivers/serial/uart_async_rx.h>
+#endif
+
+static const struct device *rx_dev;
+static uart_line_handler_t line_handler;
+static uart_raw_handler_t raw_handler;
+static struct uart_line_rx_stats rx_stats;
+static K_SEM_DEFINE(rx_sem, 0, 1);
+
+#if defined(CONFIG_APP_UART_RX_ASYNC)
+
+static uint8_t rx_pool[CONFIG_APP_UART_RX_BUF_COUNT *
+		       (CONFIG_APP_UART_RX_BUF_SIZE + UART_ASYNC_RX_BUF_OVERHEAD)];
+static struct uart_async_rx async_rx;
+static atomic_t rx_disabled;
+
+static int rx_enable(void)
+{
+	uint8_t *buf = uart_async_rx_buf_req(&async_rx);
+
+	if(buf == NULL){
+		return -ENOMEM;
+	}
+	atomic_clear(&rx_disabled);
+
+	return uart_rx_enable(rx_dev, buf, uart_async_rx_get_buf_len(&async_rx),
+			      CONFIG_APP_UART_RX_TIMEOUT_US);
+}
+
+void uart_line_rx_async_handler(const struct device *dev, struct uart_event *evt)
+{
+	uint8_t *buf;
+
+	switch(evt->type){
+	case UART_RX_RDY:
+		uart_async_rx_on_rdy(&async_rx, evt->data.rx.buf, evt->data.rx.len);
+		rx_stats.rx_bytes += evt->data.rx.len;
+		k_sem_give(&rx_sem);
+		break;
+	case UART_RX_BUF_REQUEST:
+		/* Ping-pong: hand over the next free buffer while the current one fills */
+		buf = uart_async_rx_buf_req(&async_rx);
+		if(buf != NULL){
+			uart_rx_buf_rsp(dev, buf, uart_async_rx_get_buf_len(&async_rx));
+		}
+		break;
+	case UART_RX_BUF_RELEASED:
+		uart_async_rx_on_buf_rel(&async_rx, evt->data.rx_buf.buf);
+		break;
+	case UART_RX_DISABLED:
+		/* All buffers were full, re-enabled once the thread frees one */
+		atomic_set(&rx_disabled, 1);
+		k_sem_give(&rx_sem);
+		break;
+	case UART_RX_STOPPED:
+		/* A receiver error, not a byte count: the driver disables reception next */
+		rx_stats.rx_errors++;
+		break;
+	default:
+		break;
+	}
+}
+
+static int rx_backend_start(void)
+{
+	const struct uart_async_rx_config config = {
+		.buffer = rx_pool,
+		.length = sizeof(rx_pool),
+		.buf_cnt = CONFIG_APP_UART_RX_BUF_COUNT,
+	};
+	int ret;
+
+	ret = uart_async_rx_init(&async_rx, &config);
+	if(ret < 0){
+		return ret;
+	}
+	ret = uart_port_init(rx_dev);
+	if(ret < 0){
+		return ret;
+	}
+
+	return rx_enable();
+}
+
+static size_t rx_claim(uint8_t **data)
+{
+	return uart_async_rx_data_claim(&async_rx, data, SIZE_MAX);
+}
+
+static void rx_consume(size_t len)
+{
+	uart_async_rx_data_consume(&async_rx, len);
+}
+
+/* Restart reception if the driver stopped for lack of a free buffer */
+static void rx_resume(void)
+{
+	if(atomic_get(&rx_disabled)){
+		rx_enable();
+	}
+}
+
+#else /* CONFIG_APP_UART_RX_IRQ */
+
+RING_BUF_DECLARE(rx_ring, CONFIG_APP_UART_RX_BUF_SIZE * CONFIG_APP_UART_RX_BUF_COUNT);
+
+/*
+ * The port callback also runs for TX-only users (uart_pol's echo), whose
+ * input must stay in the FIFO for uart_poll_in(), so nothing is read
+ * before uart_line_rx_start()
+ */
+static atomic_t rx_started;
+
+void uart_line_rx_irq_handler(const struct device *dev)
+{
+	uint8_t *data;
+	uint8_t discard;
+	uint32_t space;
+	int len;
+
+	if(!atomic_get(&rx_started) || !uart_irq_rx_ready(dev)){
+		return;
+	}
+
+	/* Drain the FIFO until it reports empty */
+	do{
+		space = ring_buf_put_claim(&rx_ring, &data, UINT32_MAX);
+		if(space == 0){
+			len = uart_fifo_read(dev, &discard, 1);
+			rx_stats.dropped_bytes += MAX(len, 0);
+		}else{
+			len = uart_fifo_read(dev, data, space);
+			ring_buf_put_finish(&rx_ring, MAX(len, 0));
+			rx_stats.rx_bytes += MAX(len, 0);
+		}
+	}while(len > 0);
+
+	k_sem_give(&rx_sem);
+}
+
+static int rx_backend_start(void)
+{
+	int ret = uart_port_init(rx_dev);
+
+	if(ret < 0){
+		return ret;
+	}
+	atomic_set(&rx_started, 1);
+	uart_irq_rx_enable(rx_dev);
+
+	return 0;
+}
+
+static size_t rx_claim(uint8_t **data)
+{
+	return ring_buf_get_claim(&rx_ring, data, UINT32_MAX);
+}
+
+static void rx_consume(size_t len)
+{
+	ring_buf_get_finish(&rx_ring, len);
+}
+
+static void rx_resume(void)
+{
+}
+
+#endif /* CONFIG_APP_UART_RX_ASYNC */
+
+int uart_line_rx_start(const struct device *dev, uart_line_handler_t handler)
+{
+	rx_dev = dev;
+	line_handler = handler;
+
+	return rx_backend_start();
+}
+
+int uart_line_rx_start_raw(const struct device *dev, uart_raw_handler_t handler)
+{
+	rx_dev = dev;
+	raw_handler = handler;
+
+	return rx_backend_start();
+}
+
+void uart_line_rx_stats_get(struct uart_line_rx_stats *stats)
+{
+	*stats = rx_stats;
+}
+
+/* Frames CR/LF terminated lines out of the receive buffers and dispatches them */
+static void uart_line_rx_thread(void *a, void *b, void *c)
+{
+	static char line[CONFIG_APP_UART_LINE_MAX];
+	size_t line_len = 0;
+	bool overrun = false;
+	uint8_t *data;
+	size_t len;
+
+	while(1){
+		k_sem_take(&rx_sem, K_FOREVER);
+
+		while((len = rx_claim(&data)) > 0){
+			if(raw_handler != NULL){
+				raw_handler(data, len);
+				rx_consume(len);
+				continue;
+			}
+
+			for(size_t i = 0; i < len; i++){
+				char ch = data[i];
+
+				if(ch == '\n' || ch == '\r'){
+					if(line_len > 0 && !overrun){
+						line[line_len] = '\0';
+						rx_stats.lines++;
+						line_handler(line, line_len);
+					}
+					line_len = 0;
+					overrun = false;
+				}else if(line_len < sizeof(line) - 1){
+					line[line_len++] = ch;
+				}else if(!overrun){
+					overrun = true;
+					rx_stats.overruns++;
+				}
+			}
+			rx_consume(len);
+		}
+		rx_resume();
+	}
+}
+
+K_THREAD_DEFINE(uart_line_rx_id, CONFIG_APP_UART_RX_THREAD_STACK_SIZE, uart_line_rx_thread,
+		NULL, NULL, NULL, CONFIG_APP_UART_RX_THREAD_PRIORITY, 0, 0);
@@ -0,0 +1,60 @@
+/**
+ * @file uart_line_rx.h
+ * @brief Line-oriented UART reception shared by the uart samples.
+ *
+ * Bytes are moved out of interrupt context as a region of the receive
+ * buffer (async DMA buffers or an interrupt-fed ring buffer). Line framing
+ * and the line handler run in a dedicated thread, so handlers may block,
+ * print or drive GPIOs.
+ */
+
+#ifndef UART_LINE_RX_H
+#define UART_LINE_RX_H
+
+#include <zephyr/device.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Called from the line receive thread with a NUL-terminated line, without CR/LF.
+ * The handler may modify the line in place (e.g. tokenize it) until it returns.
+ */
+typedef void (*uart_line_handler_t)(char *line, size_t len);
+
+/* Called from the line receive thread with each received burst, parsed in place */
+typedef void (*uart_raw_handler_t)(const uint8_t *data, size_t len);
+
+struct uart_line_rx_stats {
+	uint32_t rx_bytes;      // Bytes received from the UART
+	uint32_t lines;         // Lines handed to the handler
+	uint32_t overruns;      // Lines discarded for exceeding CONFIG_APP_UART_LINE_MAX
+	uint32_t dropped_bytes; // Bytes lost because no receive buffer was free
+	uint32_t rx_errors;     // Receiver errors (overrun, framing, ...) that stopped reception
+};
+
+/**
+ * @brief Start line reception on a UART.
+ *
+ * Input: dev      UART device.
+ *        handler  Line handler, called from the line receive thread.
+ *
+ * Returns: 0  Success
+ *         <0  Error code from the UART driver
+ */
+int uart_line_rx_start(const struct device *dev, uart_line_handler_t handler);
+
+/**
+ * @brief Start reception without line framing.
+ *
+ * Every burst of received bytes is handed to the handler as soon as the
+ * driver reports it, still from the line receive thread.
+ *
+ * Returns: 0  Success
+ *         <0  Error code from the UART driver
+ */
+int uart_line_rx_start_raw(const struct device *dev, uart_raw_handler_t handler);
+
+/* Copy the current receive statistics */
+void uart_line_rx_stats_get(struct uart_line_rx_stats *stats);
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file uart_port.c
+ * @brief Single owner of the UART driver callback for the shared UART layer.
+ */
+
+#include "uart_port.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+static atomic_t port_started;
+
+__weak void uart_line_rx_irq_handler(const struct device *dev)
+{
+}
+
+__weak void uart_tx_irq_handler(const struct device *dev)
+{
+}
+
+__weak void uart_line_rx_async_handler(const struct device *dev, struct uart_event *evt)
+{
+}
+
+__weak void uart_tx_async_handler(const struct device *dev, struct uart_event *evt)
+{
+}
+
+#if defined(CONFIG_APP_UART_RX_ASYNC)
+
+static void uart_port_async_cb(const struct device *dev, struct uart_event *evt, void *user_data)
+{
+	uart_line_rx_async_handler(dev, evt);
+	uart_tx_async_handler(dev, evt);
+}
+
+#else
+
+static void uart_port_irq_cb(const struct device *dev, void *user_data)
+{
+	if(!uart_irq_update(dev)){
+		return;
+	}
+	uart_line_rx_irq_handler(dev);
+	uart_tx_irq_handler(dev);
+}
+
+#endif
+
+int uart_port_init(const struct device *dev)
+{
+	if(atomic_set(&port_started, 1)){
+		return 0;
+	}
+
+#if defined(CONFIG_APP_UART_RX_ASYNC)
+	return uart_callback_set(dev, uart_port_async_cb, NULL);
+#else
+	return uart_irq_callback_user_data_set(dev, uart_port_irq_cb, NULL);
+#endif
+}
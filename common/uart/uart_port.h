@@ -0,0 +1,33 @@
+/**
+ * @file uart_port.h
+ * @brief Single owner of the UART driver callback for the shared UART layer.
+ *
+ * A UART driver accepts only one interrupt or async callback per device, so
+ * the receive and transmit modules do not register their own. The port
+ * callback fans every interrupt/event out to both; a module that is not
+ * linked into the application falls back to an empty weak handler.
+ */
+
+#ifndef UART_PORT_H
+#define UART_PORT_H
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+
+/**
+ * @brief Install the port callback on a UART, once.
+ *
+ * Returns: 0  Success or already installed
+ *         <0  Error code from the UART driver
+ */
+int uart_port_init(const struct device *dev);
+
+/* Interrupt mode handlers, called after uart_irq_update() */
+void uart_line_rx_irq_handler(const struct device *dev);
+void uart_tx_irq_handler(const struct device *dev);
+
+/* Async mode handlers, each ignores the events it does not own */
+void uart_line_rx_async_handler(const struct device *dev, struct uart_event *evt);
+void uart_tx_async_handler(const struct device *dev, struct uart_event *evt);
+
+#endif
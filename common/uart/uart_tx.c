@@ -0,0 +1,166 @@
+/**
+ * @file uart_tx.c
+ * @brief Non-blocking buffered UART transmit shared by the uart samples.
+ *
+ * Writers copy into a ring buffer under a spinlock. In interrupt mode the
+ * TX-ready interrupt fills the hardware FIFO straight from claimed ring
+ * buffer space and disables itself once the ring is empty. In async mode the
+ * largest contiguous region is handed to uart_tx() and released on TX_DONE.
+ */
+
+#include "uart_tx.h"
+#include "uart_port.h"
+
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <stdarg.h>
+
+#define TX_PRINTF_MAX 128
+
+RING_BUF_DECLARE(tx_ring, CONFIG_APP_UART_TX_BUF_SIZE);
+
+static const struct device *tx_dev;
+static struct k_spinlock tx_lock;
+static struct uart_tx_stats tx_stats;
+static K_SEM_DEFINE(tx_space_sem, 0, 1);
+static K_SEM_DEFINE(tx_empty_sem, 0, 1);
+
+#if defined(CONFIG_APP_UART_RX_ASYNC)
+
+static atomic_t tx_busy;
+
+/* Start a DMA transfer of the next contiguous region, unless one is running */
+static void tx_kick(void)
+{
+	uint8_t *data;
+	uint32_t len;
+
+	if(!atomic_cas(&tx_busy, 0, 1)){
+		return;
+	}
+
+	len = ring_buf_get_claim(&tx_ring, &data, UINT32_MAX);
+	if(len == 0 || uart_tx(tx_dev, data, len, SYS_FOREVER_US) != 0){
+		ring_buf_get_finish(&tx_ring, 0);
+		atomic_clear(&tx_busy);
+		k_sem_give(&tx_empty_sem);
+	}
+}
+
+void uart_tx_async_handler(const struct device *dev, struct uart_event *evt)
+{
+	if(evt->type != UART_TX_DONE && evt->type != UART_TX_ABORTED){
+		return;
+	}
+
+	ring_buf_get_finish(&tx_ring, evt->data.tx.len);
+	tx_stats.tx_bytes += evt->data.tx.len;
+	atomic_clear(&tx_busy);
+	k_sem_give(&tx_space_sem);
+	tx_kick();
+}
+
+#else /* CONFIG_APP_UART_RX_IRQ */
+
+static void tx_kick(void)
+{
+	uart_irq_tx_enable(tx_dev);
+}
+
+void uart_tx_irq_handler(const struct device *dev)
+{
+	uint8_t *data;
+	uint32_t len;
+	int sent;
+
+	if(!uart_irq_tx_ready(dev)){
+		return;
+	}
+
+	len = ring_buf_get_claim(&tx_ring, &data, UINT32_MAX);
+	if(len == 0){
+		uart_irq_tx_disable(dev);
+		k_sem_give(&tx_empty_sem);
+		return;
+	}
+
+	sent = uart_fifo_fill(dev, data, len);
+	ring_buf_get_finish(&tx_ring, MAX(sent, 0));
+	tx_stats.tx_bytes += MAX(sent, 0);
+	k_sem_give(&tx_space_sem);
+}
+
+#endif /* CONFIG_APP_UART_RX_ASYNC */
+
+int uart_tx_init(const struct device *dev)
+{
+	tx_dev = dev;
+
+	return uart_port_init(dev);
+}
+
+size_t uart_tx_write(const void *buf, size_t len)
+{
+	const uint8_t *src = buf;
+	size_t written = 0;
+	k_timepoint_t end = sys_timepoint_calc(K_MSEC(CONFIG_APP_UART_TX_BLOCK_TIMEOUT_MS));
+	k_spinlock_key_t key;
+
+	while(written < len){
+		key = k_spin_lock(&tx_lock);
+		written += ring_buf_put(&tx_ring, &src[written], len - written);
+		k_spin_unlock(&tx_lock, key);
+		tx_kick();
+
+		if(written == len || k_is_in_isr() || CONFIG_APP_UART_TX_BLOCK_TIMEOUT_MS == 0){
+			break;
+		}
+		if(k_sem_take(&tx_space_sem, sys_timepoint_timeout(end)) != 0){
+			break;
+		}
+	}
+
+	tx_stats.dropped_bytes += len - written;
+	return written;
+}
+
+size_t uart_tx_printf(const char *fmt, ...)
+{
+	char buf[TX_PRINTF_MAX];
+	va_list args;
+	int len;
+
+	va_start(args, fmt);
+	len = vsnprintk(buf, sizeof(buf), fmt, args);
+	va_end(args);
+
+	if(len < 0){
+		return 0;
+	}
+	return uart_tx_write(buf, MIN((size_t)len, sizeof(buf) - 1));
+}
+
+int uart_tx_flush(k_timeout_t timeout)
+{
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+
+	while(1){
+		/* Reset before checking so a drain completing in between is not lost */
+		k_sem_reset(&tx_empty_sem);
+		if(ring_buf_is_empty(&tx_ring)){
+			break;
+		}
+		tx_kick();
+		if(k_sem_take(&tx_empty_sem, sys_timepoint_timeout(end)) != 0){
+			return -EAGAIN;
+		}
+	}
+	return 0;
+}
+
+void uart_tx_stats_get(struct uart_tx_stats *stats)
+{
+	*stats = tx_stats;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file uart_tx.h
+ * @brief Non-blocking buffered UART transmit shared by the uart samples.
+ *
+ * Data is copied into a ring buffer and drained by the TX-ready interrupt
+ * or by async (DMA) transfers, so writers return immediately instead of
+ * busy-waiting per byte in uart_poll_out().
+ */
+
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct uart_tx_stats {
+	uint32_t tx_bytes;      // Bytes handed to the driver
+	uint32_t dropped_bytes; // Bytes rejected because the ring buffer was full
+};
+
+/* Bind the transmit path to a UART */
+int uart_tx_init(const struct device *dev);
+
+/**
+ * @brief Queue data for transmission.
+ *
+ * Never busy-waits. From a thread it waits at most
+ * CONFIG_APP_UART_TX_BLOCK_TIMEOUT_MS for space; from an ISR it never waits.
+ *
+ * Returns: number of bytes queued, the remainder is dropped and counted.
+ */
+size_t uart_tx_write(const void *buf, size_t len);
+
+/* printf-style formatting into uart_tx_write() */
+size_t uart_tx_printf(const char *fmt, ...);
+
+/**
+ * @brief Wait until all queued data has been handed to the driver.
+ *
+ * Returns: 0  Ring buffer empty
+ *         -EAGAIN  Timed out
+ */
+int uart_tx_flush(k_timeout_t timeout);
+
+/* Copy the current transmit statistics */
+void uart_tx_stats_get(struct uart_tx_stats *stats);
+
+#endif
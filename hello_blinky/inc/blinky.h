@@ -3,5 +3,6 @@
 #ifndef IS_BLINKY
 #define IS_BLINKY
 
-void is_blinking();
+/* Returns 1 once the LED blinks on its own, 0 if it cannot blink */
+int is_blinking(void);
 #endif
@@ -10,16 +10,60 @@
 /* The devicetree node identifier for the "led0" alias. */
 #define LED0_NODE DT_ALIAS(led0)
 
+#if DT_NODE_HAS_STATUS_OKAY(DT_ALIAS(pwm_led0)) && defined(CONFIG_PWM)
+
+#include "led_seq.h"
+
+/*
+ * With a PWM LED the blink is compiled into a sequence the PWM plays by
+ * itself, nothing runs on the CPU per toggle.
+ */
+static const struct pwm_dt_spec pwm_led = PWM_DT_SPEC_GET(DT_ALIAS(pwm_led0));
+static struct led_seq seq;
+static struct led_seq_step blink_steps[2];
+static struct led_seq_pattern blink = { .steps = blink_steps };
+
+int is_blinking(void)
+{
+	int ret;
+
+	if (led_seq_init(&seq, &pwm_led) < 0) {
+		return 0;
+	}
+
+	ret = led_seq_compile_blink(&seq, blink_steps, ARRAY_SIZE(blink_steps),
+				    SLEEP_TIME_MS, SLEEP_TIME_MS);
+	if (ret < 0) {
+		return 0;
+	}
+	blink.count = ret;
+
+	if (led_seq_start(&seq, &blink) < 0) {
+		return 0;
+	}
+	printf("LED blinking, %s\n", ret == 1 ? "PWM timed" : "timer stepped");
+	return 1;
+}
+
+#else
+
 /*
  * A build error on this line means your board is unsupported.
  * See the sample documentation for information on how to fix this.
  */
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(LED0_NODE, gpios);
 
+static void blink_expiry(struct k_timer *timer)
+{
+	gpio_pin_toggle_dt(&led);
+}
+
+static K_TIMER_DEFINE(blink_timer, blink_expiry, NULL);
+
+/* GPIO LED: toggled from a periodic timer instead of a sleeping loop */
 int is_blinking(void)
 {
 	int ret;
-	bool led_state = true;
 
 	if (!gpio_is_ready_dt(&led)) {
 		return 0;
@@ -30,15 +74,9 @@ int is_blinking(void)
 		return 0;
 	}
 
-	while (1) {
-		ret = gpio_pin_toggle_dt(&led);
-		if (ret < 0) {
-			return 0;
-		}
-
-		led_state = !led_state;
-		printf("LED state: %s\n", led_state ? "ON" : "OFF");
-		k_msleep(SLEEP_TIME_MS);
-	}
-	return 0;
+	k_timer_start(&blink_timer, K_MSEC(SLEEP_TIME_MS), K_MSEC(SLEEP_TIME_MS));
+	printf("LED blinking, timer toggled\n");
+	return 1;
 }
+
+#endif
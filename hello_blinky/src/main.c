@@ -5,6 +5,8 @@
  */
 
 #include <stdio.h>
+#include <zephyr/kernel.h>
+#include "../inc/blinky.h"
 
 int main(void)
 {
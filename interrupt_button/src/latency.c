@@ -0,0 +1,172 @@
+/*Button edge to LED action latency harness
+ * The main thread drives press/release edges onto the button input and
+ * stamps each press. The deferred handler reports the ISR stamp, its own
+ * entry and the time the LED toggle returned; the three latencies relative
+ * to the injected edge go into log2 histograms. Presses that never reach
+ * the handler are counted as missed.*/
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#if defined(CONFIG_GPIO_EMUL)
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#endif
+
+#include "latency.h"
+
+#define HIST_BUCKETS	32
+#define LOAD_WINDOW_US	10000
+
+#define BUTTON_NODE DT_ALIAS(sw0)
+
+#if !defined(CONFIG_GPIO_EMUL) && !DT_NODE_EXISTS(DT_ALIAS(latency_out))
+#error "Latency harness needs the GPIO emulator or a latency-out alias jumpered to sw0"
+#endif
+
+struct hist {
+	uint32_t bucket[HIST_BUCKETS];
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+};
+
+enum stage {
+	STAGE_ISR,
+	STAGE_HANDLER,
+	STAGE_ACTION,
+	STAGE_COUNT,
+};
+
+static const char *const stage_names[STAGE_COUNT] = {
+	"edge->ISR", "edge->handler", "edge->LED",
+};
+
+static struct hist hists[STAGE_COUNT];
+static volatile uint32_t inject_cycles;
+static atomic_t injected;
+static atomic_t handled;
+static atomic_t pending;
+
+#if defined(CONFIG_GPIO_EMUL)
+static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET(BUTTON_NODE, gpios);
+
+static void drive_button(int pressed)
+{
+	bool active_low = button.dt_flags & GPIO_ACTIVE_LOW;
+
+	gpio_emul_input_set(button.port, button.pin, pressed != active_low);
+}
+#else
+static const struct gpio_dt_spec latency_out = GPIO_DT_SPEC_GET(DT_ALIAS(latency_out), gpios);
+
+static void drive_button(int pressed)
+{
+	gpio_pin_set_dt(&latency_out, pressed);
+}
+#endif
+
+static void hist_add(struct hist *h, uint32_t cycles)
+{
+	int idx = cycles ? 32 - __builtin_clz(cycles) : 0;
+
+	h->bucket[MIN(idx, HIST_BUCKETS - 1)]++;
+	h->count++;
+	h->sum += cycles;
+	h->min = MIN(h->min, cycles);
+	h->max = MAX(h->max, cycles);
+}
+
+static uint32_t cyc_to_ns(uint64_t cycles)
+{
+	return (uint32_t)k_cyc_to_ns_floor64(cycles);
+}
+
+void latency_record(uint32_t isr_cycles, uint32_t handler_cycles, uint32_t action_cycles)
+{
+	uint32_t t0 = inject_cycles;
+
+	/*Only the first handled press per injected edge counts*/
+	if(!atomic_cas(&pending, 1, 0)){
+		return;
+	}
+	hist_add(&hists[STAGE_ISR], isr_cycles - t0);
+	hist_add(&hists[STAGE_HANDLER], handler_cycles - t0);
+	hist_add(&hists[STAGE_ACTION], action_cycles - t0);
+	atomic_inc(&handled);
+}
+
+/*Synthetic load: busy for LOAD_PCT of every window*/
+static void load_thread(void *a, void *b, void *c)
+{
+	uint32_t busy_us = LOAD_WINDOW_US * CONFIG_APP_LATENCY_LOAD_PCT / 100;
+
+	while(1){
+		k_busy_wait(busy_us);
+		k_usleep(LOAD_WINDOW_US - busy_us);
+	}
+}
+
+K_THREAD_DEFINE(load_id, 1024, load_thread, NULL, NULL, NULL,
+		CONFIG_APP_LATENCY_LOAD_PRIORITY, 0, SYS_FOREVER_MS);
+
+static void print_hist(enum stage s)
+{
+	const struct hist *h = &hists[s];
+
+	printk("%-14s min %8u  avg %8u  max %8u ns\n", stage_names[s],
+	       cyc_to_ns(h->count ? h->min : 0), cyc_to_ns(h->sum / MAX(h->count, 1)),
+	       cyc_to_ns(h->max));
+	for(int i = 0; i < HIST_BUCKETS; i++){
+		if(h->bucket[i]){
+			printk("    < %8u ns: %u\n", cyc_to_ns(BIT64(i)), h->bucket[i]);
+		}
+	}
+}
+
+void latency_harness_run(void)
+{
+	uint32_t hold_ms = CONFIG_APP_LATENCY_INTERVAL_MS / 2;
+
+#if !defined(CONFIG_GPIO_EMUL)
+	if(gpio_pin_configure_dt(&latency_out, GPIO_OUTPUT_INACTIVE) < 0){
+		printk("latency-out pin not usable\n");
+		return;
+	}
+#endif
+	for(int s = 0; s < STAGE_COUNT; s++){
+		hists[s] = (struct hist){ .min = UINT32_MAX };
+	}
+
+	printk("Latency harness: %d presses every %d ms, %d%% load at priority %d\n",
+	       CONFIG_APP_LATENCY_EDGES, CONFIG_APP_LATENCY_INTERVAL_MS,
+	       CONFIG_APP_LATENCY_LOAD_PCT, CONFIG_APP_LATENCY_LOAD_PRIORITY);
+	if(CONFIG_APP_LATENCY_LOAD_PCT > 0){
+		k_thread_start(load_id);
+	}
+
+	for(int i = 0; i < CONFIG_APP_LATENCY_EDGES; i++){
+		/*A press still pending from the last round was missed*/
+		atomic_set(&pending, 1);
+		inject_cycles = k_cycle_get_32();
+		drive_button(1);
+		atomic_inc(&injected);
+		k_msleep(hold_ms);
+		drive_button(0);
+		k_msleep(CONFIG_APP_LATENCY_INTERVAL_MS - hold_ms);
+	}
+	atomic_clear(&pending);
+
+	if(CONFIG_APP_LATENCY_LOAD_PCT > 0){
+		k_thread_suspend(load_id);
+	}
+
+	for(int s = 0; s < STAGE_COUNT; s++){
+		print_hist(s);
+	}
+	printk("Injected %ld, handled %ld, missed %ld\n", atomic_get(&injected),
+	       atomic_get(&handled), atomic_get(&injected) - atomic_get(&handled));
+}
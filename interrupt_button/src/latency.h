@@ -0,0 +1,14 @@
+/*Button edge to LED action latency harness*/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+/*Record one handled press: ISR stamp, deferred handler entry, LED toggled*/
+void latency_record(uint32_t isr_cycles, uint32_t handler_cycles, uint32_t action_cycles);
+
+/*Inject edges on the button input, print histograms when done*/
+void latency_harness_run(void);
+
+#endif
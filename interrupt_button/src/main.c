@@ -3,17 +3,30 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 
+#include "button_input.h"
+#if defined(CONFIG_APP_LATENCY_HARNESS)
+#include "latency.h"
+#endif
 
 #define LED_NODE    DT_ALIAS(led1)
 #define BUTTON_NODE DT_ALIAS(sw0)
 
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(LED_NODE, gpios);
 static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET(BUTTON_NODE, gpios);
-static struct gpio_callback button_cb_data;
+static struct button_input button_in;
 
-//ISR
-void button_pressed_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins){
-	gpio_pin_toggle_dt(&led);
+//Deferred handler, the ISR only timestamps and queues the edge
+static void button_event(struct button_input *btn, enum button_evt evt, uint32_t edge_cycles){
+	if(evt == BUTTON_EVT_PRESS){
+		uint32_t handler_cycles = k_cycle_get_32();
+
+		gpio_pin_toggle_dt(&led);
+#if defined(CONFIG_APP_LATENCY_HARNESS)
+		latency_record(edge_cycles, handler_cycles, k_cycle_get_32());
+#else
+		ARG_UNUSED(handler_cycles);
+#endif
+	}
 }
 
 void main(void)
@@ -23,20 +36,13 @@ void main(void)
 	if(ret<0){
 		return;
 	}
-	ret=gpio_pin_configure_dt(&button, GPIO_INPUT);
+	ret = button_input_init(&button_in, &button, button_event, NULL);
 	if(ret<0){
 		return;
 	}
-	ret =gpio_pin_interrupt_configure_dt(&button, GPIO_INT_EDGE_FALLING);
-	if(ret<0){
-		return;
-	}
-
-	gpio_init_callback(&button_cb_data, button_pressed_isr, BIT(button.pin));
-	gpio_add_callback(button.port, &button_cb_data);
-	
-	while(1)
-	{
-		k_msleep(1000);
-	}
+#if defined(CONFIG_APP_LATENCY_HARNESS)
+	latency_harness_run();
+	printk("Bounces %u, edge queue overflows %u\n", button_input_bounces(&button_in),
+	       button_input_overflows(&button_in));
+#endif
 }
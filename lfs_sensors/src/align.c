@@ -0,0 +1,78 @@
+/**
+ * @file align.c
+ * @brief Nearest/linear time alignment of sensor channels.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#include "align.h"
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+static uint64_t ts_dist(uint64_t a, uint64_t b)
+{
+	return a > b ? a - b : b - a;
+}
+
+//==============================================================================
+// Function Definitions
+//==============================================================================
+
+void align_push(struct align_channel *ch, uint64_t ts_ns, const double *vals)
+{
+	if (ch->count > 0) {
+		ch->ts[0] = ch->ts[1];
+		memcpy(ch->val[0], ch->val[1], ch->nvals * sizeof(double));
+	}
+	ch->ts[1] = ts_ns;
+	memcpy(ch->val[1], vals, ch->nvals * sizeof(double));
+	ch->count = MIN(ch->count + 1, 2);
+}
+
+int align_common_time(struct align_channel *const *chs, size_t count, uint64_t *t_ns)
+{
+	uint64_t t = UINT64_MAX;
+
+	for (size_t i = 0; i < count; i++) {
+		if (chs[i]->count == 0) {
+			return -EAGAIN;
+		}
+		t = MIN(t, chs[i]->ts[1]);
+	}
+	*t_ns = t;
+	return 0;
+}
+
+bool align_at(const struct align_channel *ch, uint64_t t_ns, double *out, uint64_t *err_ns)
+{
+	const uint64_t *ts = ch->ts;
+	int nearest = 1;
+
+	if (ch->count == 2 && ts_dist(ts[0], t_ns) < ts_dist(ts[1], t_ns)) {
+		nearest = 0;
+	}
+	*err_ns = ts_dist(ts[nearest], t_ns);
+
+#if defined(CONFIG_APP_ALIGN_LINEAR)
+	if (ch->count == 2 && ts[0] <= t_ns && t_ns <= ts[1] && ts[1] > ts[0]) {
+		double w = (double)(t_ns - ts[0]) / (double)(ts[1] - ts[0]);
+
+		for (size_t i = 0; i < ch->nvals; i++) {
+			out[i] = ch->val[0][i] + w * (ch->val[1][i] - ch->val[0][i]);
+		}
+		return true;
+	}
+#endif
+
+	memcpy(out, ch->val[nearest], ch->nvals * sizeof(double));
+	return IS_ENABLED(CONFIG_APP_ALIGN_NEAREST) || *err_ns == 0;
+}
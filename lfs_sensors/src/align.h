@@ -0,0 +1,57 @@
+/**
+ * @file align.h
+ * @brief Time alignment of sensor channels sampled at different instants.
+ *
+ * Each channel keeps its two most recent samples. A record is built at the
+ * newest instant every channel has reached, and each channel is resampled
+ * there either from its nearest sample or by linear interpolation between
+ * the two samples bracketing it (APP_ALIGN_MODE).
+ */
+
+#ifndef ALIGN_H
+#define ALIGN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ALIGN_MAX_VALUES	6
+
+/* Zero initialized apart from nvals, the number of doubles per sample */
+struct align_channel {
+	size_t nvals;
+	uint8_t count;
+	uint64_t ts[2];				// [0] older, [1] newest
+	double val[2][ALIGN_MAX_VALUES];
+};
+
+/**
+ * @brief Add a sample, dropping the oldest of the two kept.
+ *
+ * Input: ch	Channel.
+ *	  ts_ns	Acquisition timestamp.
+ *	  vals	nvals doubles.
+ */
+void align_push(struct align_channel *ch, uint64_t ts_ns, const double *vals);
+
+/**
+ * @brief Newest instant every channel has a sample for.
+ *
+ * Returns: 0 on success, -EAGAIN if a channel has no sample yet.
+ */
+int align_common_time(struct align_channel *const *chs, size_t count, uint64_t *t_ns);
+
+/**
+ * @brief Resample a channel at t_ns.
+ *
+ * Input:  ch		Channel with at least one sample.
+ *	   t_ns		Target instant.
+ * Output: out		nvals doubles.
+ *	   err_ns	Distance from t_ns to the nearest real sample.
+ *
+ * Returns: false if linear interpolation had to fall back to the nearest
+ *	    sample because no pair brackets t_ns, true otherwise.
+ */
+bool align_at(const struct align_channel *ch, uint64_t t_ns, double *out, uint64_t *err_ns);
+
+#endif /* ALIGN_H */
@@ -0,0 +1,216 @@
+/**
+ * @file anomaly.c
+ * @brief Streaming anomaly detector on the sensor data bus.
+ *
+ * zbus listeners score every sample as it is published, in constant memory
+ * per channel:
+ *
+ *  humidity, temperature, pressure  z-score against an EWMA mean and
+ *                                   variance of the channel
+ *  IMU                              deviation of |accel| from 1 g, and jerk
+ *                                   between consecutive samples (full rate
+ *                                   when APP_IMU_STREAM is enabled)
+ *
+ * A detector fires once when its score crosses the limit and re-arms when
+ * the score falls back under half of it. Each firing is published on
+ * anomaly_chan, where the logger tags and writes a record immediately and
+ * the BLE export forwards it.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/zbus/zbus.h>
+#include <math.h>
+#include <string.h>
+
+#include "sensor_bus.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(anomaly, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define EWMA_ALPHA		(CONFIG_APP_ANOMALY_EWMA_ALPHA_MILLI / 1000.0f)
+#define Z_LIMIT			(CONFIG_APP_ANOMALY_Z_X10 / 10.0f)
+#define ACCEL_LIMIT		(CONFIG_APP_ANOMALY_ACCEL_MG * (SENSOR_G / 1000000.0f) / 1000.0f)
+#define JERK_LIMIT		((float)CONFIG_APP_ANOMALY_JERK)
+#define GRAVITY			(SENSOR_G / 1000000.0f)
+#define REARM_RATIO		0.5f			// Score under limit * ratio re-arms
+#define JERK_MAX_DT_NS		(500 * NSEC_PER_MSEC)	// Older previous sample is not used
+
+//==============================================================================
+// Detector State
+//==============================================================================
+
+/* Exponentially weighted mean and variance of one value */
+struct ewma_band {
+	float mean;
+	float var;
+	uint16_t n;
+};
+
+struct trigger {
+	bool active;
+};
+
+struct env_detector {
+	enum anomaly_source source;
+	const char *name;
+	float min_std;			// Floor for quantized, nearly constant signals
+	struct ewma_band band;
+	struct trigger trig;
+};
+
+/* Each entry is only touched by the listener of its own channel */
+static struct env_detector env[] = {
+	{ ANOMALY_HUMIDITY, "humidity", 0.5f },
+	{ ANOMALY_TEMPERATURE, "temperature", 0.2f },
+	{ ANOMALY_PRESSURE, "pressure", 0.05f },
+};
+
+static struct {
+	float prev[3];
+	uint64_t prev_ts_ns;
+	struct trigger accel_trig;
+	struct trigger jerk_trig;
+} imu_det;
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+/**
+ * @brief Score a value against the band, then fold it in.
+ *
+ * Returns: |z|, 0 during the first APP_ANOMALY_WARMUP samples.
+ */
+static float ewma_score_update(struct ewma_band *b, float x, float min_std)
+{
+	float d, z = 0.0f;
+
+	if (b->n == 0) {
+		b->mean = x;
+		b->var = 0.0f;
+		b->n = 1;
+		return 0.0f;
+	}
+
+	d = x - b->mean;
+	if (b->n >= CONFIG_APP_ANOMALY_WARMUP) {
+		z = fabsf(d) / MAX(sqrtf(b->var), min_std);
+	} else {
+		b->n++;
+	}
+	b->mean += EWMA_ALPHA * d;
+	b->var = (1.0f - EWMA_ALPHA) * (b->var + EWMA_ALPHA * d * d);
+	return z;
+}
+
+/**
+ * @brief Raise an event on the rising edge of score over limit.
+ */
+static void trigger_check(struct trigger *t, enum anomaly_source source, const char *name,
+			  uint64_t ts_ns, float value, float score, float limit)
+{
+	anomaly_event ev;
+
+	if (score < limit) {
+		if (score < limit * REARM_RATIO) {
+			t->active = false;
+		}
+		return;
+	}
+	if (t->active) {
+		return;
+	}
+	t->active = true;
+
+	ev.ts_ns = ts_ns;
+	ev.source = source;
+	ev.value = value;
+	ev.score = score;
+	LOG_WRN("Anomaly on %s: value %.3f score %.2f", name, (double)value, (double)score);
+	if (zbus_chan_pub(&anomaly_chan, &ev, K_NO_WAIT) < 0) {
+		LOG_ERR("anomaly_chan busy, %s event lost", name);
+	}
+}
+
+static void env_update(struct env_detector *d, uint64_t ts_ns, double value)
+{
+	float z = ewma_score_update(&d->band, (float)value, d->min_std);
+
+	trigger_check(&d->trig, d->source, d->name, ts_ns, (float)value, z, Z_LIMIT);
+}
+
+//==============================================================================
+// Listeners
+//==============================================================================
+
+/**
+ * @brief zbus listener on the environmental channels.
+ *
+ * Input: chan ht_chan or lp_chan.
+ */
+static void anomaly_env_cb(const struct zbus_channel *chan)
+{
+	if (chan == &ht_chan) {
+		const hum_temp_sample *s = zbus_chan_const_msg(chan);
+
+		env_update(&env[0], s->ts_ns, s->data.humidity);
+		env_update(&env[1], s->ts_ns, s->data.temperature);
+	} else if (chan == &lp_chan) {
+		const press_sample *s = zbus_chan_const_msg(chan);
+
+		env_update(&env[2], s->ts_ns, s->data.pressure);
+	}
+}
+
+ZBUS_LISTENER_DEFINE(anomaly_env_lis, anomaly_env_cb);
+ZBUS_CHAN_ADD_OBS(ht_chan, anomaly_env_lis, 1);
+ZBUS_CHAN_ADD_OBS(lp_chan, anomaly_env_lis, 1);
+
+/**
+ * @brief zbus listener on the IMU channel.
+ *
+ * Input: chan imu_raw_chan at the full ODR, imu_chan otherwise.
+ */
+static void anomaly_imu_cb(const struct zbus_channel *chan)
+{
+	const imu_sample *s = zbus_chan_const_msg(chan);
+	const float a[3] = { s->data.accel.x, s->data.accel.y, s->data.accel.z };
+	float dev = fabsf(sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) - GRAVITY);
+
+	trigger_check(&imu_det.accel_trig, ANOMALY_ACCEL, "accel", s->ts_ns, dev,
+		      dev / ACCEL_LIMIT, 1.0f);
+
+	if (imu_det.prev_ts_ns != 0 && s->ts_ns > imu_det.prev_ts_ns &&
+	    s->ts_ns - imu_det.prev_ts_ns < JERK_MAX_DT_NS) {
+		float dt = (float)(s->ts_ns - imu_det.prev_ts_ns) / NSEC_PER_SEC;
+		float dx = a[0] - imu_det.prev[0];
+		float dy = a[1] - imu_det.prev[1];
+		float dz = a[2] - imu_det.prev[2];
+		float jerk = sqrtf(dx * dx + dy * dy + dz * dz) / dt;
+
+		trigger_check(&imu_det.jerk_trig, ANOMALY_JERK, "jerk", s->ts_ns, jerk,
+			      jerk / JERK_LIMIT, 1.0f);
+	}
+	memcpy(imu_det.prev, a, sizeof(a));
+	imu_det.prev_ts_ns = s->ts_ns;
+}
+
+ZBUS_LISTENER_DEFINE(anomaly_imu_lis, anomaly_imu_cb);
+#if defined(CONFIG_APP_IMU_STREAM)
+ZBUS_CHAN_ADD_OBS(imu_raw_chan, anomaly_imu_lis, 1);
+#else
+ZBUS_CHAN_ADD_OBS(imu_chan, anomaly_imu_lis, 1);
+#endif
@@ -0,0 +1,373 @@
+/**
+ * @file lfs_bench.c
+ * @brief LittleFS geometry tuning benchmark on an emulated flash.
+ *
+ * Every configuration formats a RAM backed flash, then appends sensor
+ * records the way logger_func() does: open in append mode, write one
+ * record, close, rotating to a new file every FILE_SIZE bytes and deleting
+ * the oldest one so the run wraps the device several times.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <lfs.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lfs_bench.h"
+#include "lfs_profile.h"
+#include "sensor_data.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(lfs_bench, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define BENCH_FLASH_SIZE	(CONFIG_APP_LFS_BENCH_FLASH_KB * 1024)
+#define BENCH_MIN_BLOCK		2048
+#define BENCH_MAX_BLOCKS	(BENCH_FLASH_SIZE / BENCH_MIN_BLOCK)
+#define BENCH_CACHE_MAX		1024
+#define BENCH_LOOKAHEAD_MAX	64
+
+#define BENCH_RECORD_SIZE	sizeof(sensors_shared_buf)
+#define BENCH_FILE_SIZE		1024		// Same rotation size as the logger
+#define BENCH_FILES		4		// Log files kept before deleting
+
+//==============================================================================
+// Flash Models
+//==============================================================================
+
+/*
+ * Timing of one device, all in nanoseconds. A program call costs
+ * prog_cmd_ns, plus prog_byte_ns per byte moved over the bus, plus
+ * prog_unit_ns for every prog_unit aligned chunk it touches.
+ */
+struct flash_model {
+	const char *name;
+	uint32_t block_size;
+	uint32_t prog_unit;
+	uint32_t prog_cmd_ns;
+	uint32_t prog_byte_ns;
+	uint32_t prog_unit_ns;
+	uint32_t erase_ns;
+	uint32_t read_cmd_ns;
+	uint32_t read_byte_ns;
+};
+
+enum {
+	MODEL_STM32_INTERNAL,
+	MODEL_SPI_NOR,
+	MODEL_COUNT,
+};
+
+static const struct flash_model models[MODEL_COUNT] = {
+	/* STM32L4/G0: 64-bit double word programming, 2 KiB page erase */
+	[MODEL_STM32_INTERNAL] = {
+		.name = "stm32",
+		.block_size = 2048,
+		.prog_unit = 8,
+		.prog_unit_ns = 82000,
+		.erase_ns = 22000000,
+		.read_byte_ns = 10,
+	},
+	/* MX25R6435F on SPI at 8 MHz: 256-byte page program, 4 KiB sector erase */
+	[MODEL_SPI_NOR] = {
+		.name = "spi-nor",
+		.block_size = 4096,
+		.prog_unit = 256,
+		.prog_cmd_ns = 5000,
+		.prog_byte_ns = 1000,
+		.prog_unit_ns = 850000,
+		.erase_ns = 40000000,
+		.read_cmd_ns = 5000,
+		.read_byte_ns = 1000,
+	},
+};
+
+//==============================================================================
+// Benchmark Matrix
+//==============================================================================
+
+struct lfs_geom {
+	const char *label;
+	uint16_t read_size;
+	uint16_t prog_size;
+	uint16_t cache_size;
+	uint16_t lookahead_size;
+	int32_t block_cycles;
+};
+
+static const struct lfs_geom zephyr_default = {
+	"zephyr", CONFIG_FS_LITTLEFS_READ_SIZE, CONFIG_FS_LITTLEFS_PROG_SIZE,
+	CONFIG_FS_LITTLEFS_CACHE_SIZE, CONFIG_FS_LITTLEFS_LOOKAHEAD_SIZE,
+	CONFIG_FS_LITTLEFS_BLOCK_CYCLES,
+};
+
+static const struct lfs_geom board_profile = {
+	"board", LFS_PROFILE_READ_SIZE, LFS_PROFILE_PROG_SIZE, LFS_PROFILE_CACHE_SIZE,
+	LFS_PROFILE_LOOKAHEAD_SIZE, LFS_PROFILE_BLOCK_CYCLES,
+};
+
+static const struct lfs_geom stm32_matrix[] = {
+	{ "", 8, 8, 64, 8, 200 },
+	{ "", 8, 8, 256, 16, 200 },
+	{ "", 8, 8, 512, 16, 200 },
+	{ "", 8, 8, 256, 16, 100 },
+	{ "", 8, 8, 256, 16, -1 },
+	{ "", 64, 64, 256, 16, 200 },
+	{ "", 256, 256, 512, 16, 200 },
+};
+
+static const struct lfs_geom nor_matrix[] = {
+	{ "", 16, 16, 256, 16, 1000 },
+	{ "", 64, 64, 512, 16, 1000 },
+	{ "", 64, 64, 1024, 16, 1000 },
+	{ "", 256, 256, 256, 16, 1000 },
+	{ "", 256, 256, 1024, 16, 1000 },
+	{ "", 64, 64, 512, 16, 200 },
+	{ "", 64, 64, 512, 16, -1 },
+};
+
+//==============================================================================
+// Emulated Flash
+//==============================================================================
+
+struct bench_stats {
+	uint64_t flash_ns;
+	uint64_t prog_bytes;
+	uint32_t erases[BENCH_MAX_BLOCKS];
+	uint32_t bad_progs;
+};
+
+static uint8_t flash_mem[BENCH_FLASH_SIZE];
+static struct bench_stats stats;
+static const struct flash_model *model;
+
+static uint8_t __aligned(4) read_buf[BENCH_CACHE_MAX];
+static uint8_t __aligned(4) prog_buf[BENCH_CACHE_MAX];
+static uint8_t __aligned(4) file_buf[BENCH_CACHE_MAX];
+static uint32_t lookahead_buf[BENCH_LOOKAHEAD_MAX / sizeof(uint32_t)];
+
+static lfs_t lfs;
+static lfs_file_t file;
+
+static int emu_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off,
+		    void *buffer, lfs_size_t size)
+{
+	memcpy(buffer, &flash_mem[block * c->block_size + off], size);
+	stats.flash_ns += model->read_cmd_ns + (uint64_t)size * model->read_byte_ns;
+	return 0;
+}
+
+static int emu_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off,
+		    const void *buffer, lfs_size_t size)
+{
+	uint8_t *dst = &flash_mem[block * c->block_size + off];
+	const uint8_t *src = buffer;
+	uint32_t units = (off + size - 1) / model->prog_unit - off / model->prog_unit + 1;
+
+	// Programming can only clear bits
+	for (lfs_size_t i = 0; i < size; i++) {
+		if (dst[i] != 0xFF) {
+			stats.bad_progs++;
+		}
+		dst[i] &= src[i];
+	}
+
+	stats.prog_bytes += size;
+	stats.flash_ns += model->prog_cmd_ns + (uint64_t)size * model->prog_byte_ns +
+			  (uint64_t)units * model->prog_unit_ns;
+	return 0;
+}
+
+static int emu_erase(const struct lfs_config *c, lfs_block_t block)
+{
+	memset(&flash_mem[block * c->block_size], 0xFF, c->block_size);
+	stats.erases[block]++;
+	stats.flash_ns += model->erase_ns;
+	return 0;
+}
+
+static int emu_sync(const struct lfs_config *c)
+{
+	return 0;
+}
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+/**
+ * @brief Check a geometry against the LittleFS constraints and our buffers.
+ *
+ * Returns: true if the configuration can be mounted on the model.
+ */
+static bool geom_valid(const struct lfs_geom *g)
+{
+	return g->read_size && g->prog_size && g->cache_size <= BENCH_CACHE_MAX &&
+	       g->cache_size % g->read_size == 0 && g->cache_size % g->prog_size == 0 &&
+	       model->block_size % g->cache_size == 0 &&
+	       g->lookahead_size && g->lookahead_size % 8 == 0 &&
+	       g->lookahead_size <= BENCH_LOOKAHEAD_MAX;
+}
+
+/**
+ * @brief Append records until the count is reached or LittleFS fails.
+ *
+ * Returns: number of records written.
+ */
+static uint32_t bench_workload(lfs_t *fs)
+{
+	static const struct lfs_file_config file_cfg = { .buffer = file_buf };
+	uint8_t record[BENCH_RECORD_SIZE];
+	char name[16];
+	uint32_t file_num = 0;
+	uint32_t n;
+
+	for (n = 0; n < CONFIG_APP_LFS_BENCH_RECORDS; n++) {
+		memset(record, (uint8_t)n, sizeof(record));
+
+		snprintf(name, sizeof(name), "sensor%u.log", file_num);
+		if (lfs_file_opencfg(fs, &file, name, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND,
+				     &file_cfg) < 0) {
+			break;
+		}
+		if (lfs_file_write(fs, &file, record, sizeof(record)) != sizeof(record)) {
+			lfs_file_close(fs, &file);
+			break;
+		}
+		lfs_soff_t size = lfs_file_size(fs, &file);
+
+		if (lfs_file_close(fs, &file) < 0) {
+			break;
+		}
+
+		if (size >= BENCH_FILE_SIZE) {
+			file_num++;
+			if (file_num >= BENCH_FILES) {
+				snprintf(name, sizeof(name), "sensor%u.log", file_num - BENCH_FILES);
+				lfs_remove(fs, name);
+			}
+		}
+	}
+	return n;
+}
+
+/**
+ * @brief Format, run the workload and log one result row.
+ *
+ * Input: g	Geometry under test.
+ */
+static void bench_one(const struct lfs_geom *g)
+{
+	uint32_t blocks = BENCH_FLASH_SIZE / model->block_size;
+	struct lfs_config cfg = {
+		.read = emu_read,
+		.prog = emu_prog,
+		.erase = emu_erase,
+		.sync = emu_sync,
+		.read_size = g->read_size,
+		.prog_size = g->prog_size,
+		.block_size = model->block_size,
+		.block_count = blocks,
+		.block_cycles = g->block_cycles,
+		.cache_size = g->cache_size,
+		.lookahead_size = g->lookahead_size,
+		.read_buffer = read_buf,
+		.prog_buffer = prog_buf,
+		.lookahead_buffer = lookahead_buf,
+	};
+	uint32_t ram = 3 * g->cache_size + g->lookahead_size;
+	uint32_t records, erase_max = 0, erase_sum = 0;
+	uint64_t cpu_ns, total_ns;
+	uint32_t start;
+
+	if (!geom_valid(g)) {
+		LOG_INF("%-8s %4u %4u %5u %3u %5d | invalid for %u byte blocks", g->label,
+			g->read_size, g->prog_size, g->cache_size, g->lookahead_size,
+			g->block_cycles, model->block_size);
+		return;
+	}
+
+	memset(flash_mem, 0xFF, sizeof(flash_mem));
+	memset(&stats, 0, sizeof(stats));
+
+	if (lfs_format(&lfs, &cfg) < 0 || lfs_mount(&lfs, &cfg) < 0) {
+		LOG_ERR("%s: format/mount failed", g->label);
+		return;
+	}
+	// Only the workload is measured, not the format
+	memset(&stats, 0, sizeof(stats));
+
+	start = k_cycle_get_32();
+	records = bench_workload(&lfs);
+	cpu_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+	lfs_unmount(&lfs);
+
+	for (uint32_t b = 0; b < blocks; b++) {
+		erase_max = MAX(erase_max, stats.erases[b]);
+		erase_sum += stats.erases[b];
+	}
+	total_ns = MAX(cpu_ns + stats.flash_ns, 1);
+
+	LOG_INF("%-8s %4u %4u %5u %3u %5d | %8.1f %6.2f %5u | %5u %6.1f%s", g->label,
+		g->read_size, g->prog_size, g->cache_size, g->lookahead_size, g->block_cycles,
+		(double)records * NSEC_PER_SEC / total_ns,
+		(double)stats.prog_bytes / ((uint64_t)MAX(records, 1) * BENCH_RECORD_SIZE),
+		ram, erase_max, (double)erase_sum / blocks,
+		records < CONFIG_APP_LFS_BENCH_RECORDS ? "  (stopped early)" : "");
+	if (stats.bad_progs) {
+		LOG_WRN("%u programs hit unerased bytes", stats.bad_progs);
+	}
+}
+
+/**
+ * @brief Run the board profile, the Zephyr defaults and the model matrix.
+ *
+ * Input: m	Index of the flash model.
+ */
+static void bench_model(int m)
+{
+	const struct lfs_geom *matrix = m == MODEL_SPI_NOR ? nor_matrix : stm32_matrix;
+	size_t count = m == MODEL_SPI_NOR ? ARRAY_SIZE(nor_matrix) : ARRAY_SIZE(stm32_matrix);
+
+	model = &models[m];
+	LOG_INF("%s: %u KiB, %u byte blocks, %u records of %zu bytes", model->name,
+		CONFIG_APP_LFS_BENCH_FLASH_KB, model->block_size, CONFIG_APP_LFS_BENCH_RECORDS,
+		BENCH_RECORD_SIZE);
+	LOG_INF("%-8s %4s %4s %5s %3s %5s | %8s %6s %5s | %5s %6s", "", "read", "prog",
+		"cache", "la", "cyc", "rec/s", "WA", "RAM", "e.max", "e.avg");
+
+	bench_one(&board_profile);
+	bench_one(&zephyr_default);
+	for (size_t i = 0; i < count; i++) {
+		bench_one(&matrix[i]);
+	}
+}
+
+//==============================================================================
+// Function Definitions
+//==============================================================================
+
+void lfs_bench_run(void)
+{
+#if defined(CONFIG_APP_LFS_PROFILE_STM32_INTERNAL)
+	bench_model(MODEL_STM32_INTERNAL);
+#elif defined(CONFIG_APP_LFS_PROFILE_SPI_NOR)
+	bench_model(MODEL_SPI_NOR);
+#else
+	for (int m = 0; m < MODEL_COUNT; m++) {
+		bench_model(m);
+	}
+#endif
+}
@@ -0,0 +1,23 @@
+/**
+ * @file lfs_bench.h
+ * @brief LittleFS geometry tuning benchmark.
+ *
+ * Replays the logger's open/append/close pattern against a RAM emulated
+ * flash for a matrix of read/prog/cache/lookahead sizes and block_cycles
+ * values. Flash time is modelled per device (internal STM32 flash or SPI
+ * NOR), CPU time is measured, and each configuration reports throughput,
+ * write amplification, RAM cost and erase wear.
+ */
+
+#ifndef LFS_BENCH_H
+#define LFS_BENCH_H
+
+/**
+ * @brief Run the benchmark matrix and log the result table.
+ *
+ * Uses the flash model of the selected APP_LFS_PROFILE, or all models
+ * for the Zephyr default and custom profiles.
+ */
+void lfs_bench_run(void);
+
+#endif /* LFS_BENCH_H */
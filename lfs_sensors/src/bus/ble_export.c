@@ -0,0 +1,251 @@
+/**
+ * @file ble_export.c
+ * @brief Live sensor samples over a BLE GATT notify characteristic.
+ *
+ * A zbus message subscriber: every published sample is copied into this
+ * module's queue, so a slow or absent link only costs queued copies and
+ * never holds a channel the other consumers read.
+ *
+ * Every notification is one packed record, small enough for the default
+ * 23 byte ATT MTU:
+ *
+ *  u8   channel (0 ht, 1 lp, 2 imu, 3 orientation, 4 anomaly)
+ *  u32  sample timestamp in ms, little endian
+ *  i16  values scaled by 100 and clamped, little endian (2 ht, 1 lp, 6 imu,
+ *       3 orientation: roll, pitch, yaw in degrees,
+ *       3 anomaly: source, value, score)
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/zbus/zbus.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+
+#include "sensor_bus.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(ble_export, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define BLE_THREAD_PRIORITY	8
+#define BLE_THREAD_STACK_SIZE	1536
+
+#define BLE_VALUE_SCALE		100
+#define BLE_MAX_VALUES		6
+#define BLE_REC_HDR_LEN		5
+
+#define BT_UUID_SENSOR_SVC_VAL \
+	BT_UUID_128_ENCODE(0x6c1e0001, 0x3d2a, 0x4f5e, 0x9b1c, 0x2a7d5e8f4c30)
+#define BT_UUID_SENSOR_SAMPLE_VAL \
+	BT_UUID_128_ENCODE(0x6c1e0002, 0x3d2a, 0x4f5e, 0x9b1c, 0x2a7d5e8f4c30)
+#define BT_UUID_SENSOR_SVC	BT_UUID_DECLARE_128(BT_UUID_SENSOR_SVC_VAL)
+#define BT_UUID_SENSOR_SAMPLE	BT_UUID_DECLARE_128(BT_UUID_SENSOR_SAMPLE_VAL)
+
+//==============================================================================
+// Message Subscriber
+//==============================================================================
+
+ZBUS_MSG_SUBSCRIBER_DEFINE(ble_msub);
+ZBUS_CHAN_ADD_OBS(ht_chan, ble_msub, 2);
+ZBUS_CHAN_ADD_OBS(lp_chan, ble_msub, 2);
+ZBUS_CHAN_ADD_OBS(imu_chan, ble_msub, 2);
+#if defined(CONFIG_APP_IMU_FUSION)
+ZBUS_CHAN_ADD_OBS(orient_chan, ble_msub, 2);
+#endif
+#if defined(CONFIG_APP_ANOMALY)
+ZBUS_CHAN_ADD_OBS(anomaly_chan, ble_msub, 2);
+#endif
+
+/* Large enough for any of the sample types */
+union sample_buf {
+	hum_temp_sample ht;
+	press_sample lp;
+	imu_sample imu;
+#if defined(CONFIG_APP_IMU_FUSION)
+	orient_sample orient;
+#endif
+#if defined(CONFIG_APP_ANOMALY)
+	anomaly_event anomaly;
+#endif
+};
+
+//==============================================================================
+// GATT Service
+//==============================================================================
+
+static atomic_t notify_enabled;
+
+static void sample_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	ARG_UNUSED(attr);
+
+	atomic_set(&notify_enabled, value == BT_GATT_CCC_NOTIFY);
+	LOG_INF("Sample notifications %s", value == BT_GATT_CCC_NOTIFY ? "on" : "off");
+}
+
+BT_GATT_SERVICE_DEFINE(sensor_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_SENSOR_SVC),
+	BT_GATT_CHARACTERISTIC(BT_UUID_SENSOR_SAMPLE, BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_NONE, NULL, NULL, NULL),
+	BT_GATT_CCC(sample_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+//==============================================================================
+// Advertising
+//==============================================================================
+
+static const struct bt_data ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_SENSOR_SVC_VAL),
+};
+
+static const struct bt_data sd[] = {
+	BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME, sizeof(CONFIG_BT_DEVICE_NAME) - 1),
+};
+
+static void adv_start(struct k_work *work)
+{
+	int err;
+
+	ARG_UNUSED(work);
+
+	err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
+	if (err && err != -EALREADY) {
+		LOG_ERR("Advertising failed to start (err %d)", err);
+	}
+}
+
+static K_WORK_DEFINE(adv_work, adv_start);
+
+/* Connectable advertising stops on connection, resume once the slot is free */
+static void conn_recycled(void)
+{
+	k_work_submit(&adv_work);
+}
+
+BT_CONN_CB_DEFINE(ble_export_conn_cb) = {
+	.recycled = conn_recycled,
+};
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+/**
+ * @brief Pack a sample into a notification record.
+ *
+ * Returns: record length, 0 for a channel this module does not export.
+ */
+static size_t pack_sample(const struct zbus_channel *chan, const union sample_buf *s,
+			  uint8_t *rec)
+{
+	const double *vals;
+	uint64_t ts_ns;
+	size_t nvals;
+	uint8_t id;
+#if defined(CONFIG_APP_IMU_FUSION) || defined(CONFIG_APP_ANOMALY)
+	double conv[3];			// Float fields converted for scaling
+#endif
+
+	if (chan == &ht_chan) {
+		id = 0;
+		ts_ns = s->ht.ts_ns;
+		vals = (const double *)&s->ht.data;
+		nvals = sizeof(s->ht.data) / sizeof(double);
+	} else if (chan == &lp_chan) {
+		id = 1;
+		ts_ns = s->lp.ts_ns;
+		vals = (const double *)&s->lp.data;
+		nvals = sizeof(s->lp.data) / sizeof(double);
+	} else if (chan == &imu_chan) {
+		id = 2;
+		ts_ns = s->imu.ts_ns;
+		vals = (const double *)&s->imu.data;
+		nvals = sizeof(s->imu.data) / sizeof(double);
+#if defined(CONFIG_APP_IMU_FUSION)
+	} else if (chan == &orient_chan) {
+		id = 3;
+		ts_ns = s->orient.ts_ns;
+		conv[0] = s->orient.roll;
+		conv[1] = s->orient.pitch;
+		conv[2] = s->orient.yaw;
+		vals = conv;
+		nvals = ARRAY_SIZE(conv);
+#endif
+#if defined(CONFIG_APP_ANOMALY)
+	} else if (chan == &anomaly_chan) {
+		id = 4;
+		ts_ns = s->anomaly.ts_ns;
+		// Source goes out scaled like the values so the record stays uniform
+		conv[0] = s->anomaly.source;
+		conv[1] = s->anomaly.value;
+		conv[2] = s->anomaly.score;
+		vals = conv;
+		nvals = ARRAY_SIZE(conv);
+#endif
+	} else {
+		return 0;
+	}
+
+	rec[0] = id;
+	sys_put_le32((uint32_t)(ts_ns / NSEC_PER_MSEC), &rec[1]);
+	for (size_t i = 0; i < nvals; i++) {
+		double v = CLAMP(vals[i] * BLE_VALUE_SCALE, INT16_MIN, INT16_MAX);
+
+		sys_put_le16((uint16_t)(int16_t)v, &rec[BLE_REC_HDR_LEN + 2 * i]);
+	}
+	return BLE_REC_HDR_LEN + 2 * nvals;
+}
+
+//==============================================================================
+// Thread
+//==============================================================================
+
+static void ble_export_thread(void *, void *, void *)
+{
+	const struct zbus_channel *chan;
+	union sample_buf sample;
+	uint8_t rec[BLE_REC_HDR_LEN + 2 * BLE_MAX_VALUES];
+	int err;
+
+	err = bt_enable(NULL);
+	if (err) {
+		LOG_ERR("Bluetooth init failed (err %d)", err);
+		return;
+	}
+	adv_start(NULL);
+	LOG_INF("BLE export advertising as \"%s\"", CONFIG_BT_DEVICE_NAME);
+
+	while (zbus_sub_wait_msg(&ble_msub, &chan, &sample, K_FOREVER) == 0) {
+		size_t len;
+
+		if (!atomic_get(&notify_enabled)) {
+			continue;
+		}
+		len = pack_sample(chan, &sample, rec);
+		if (len == 0) {
+			continue;
+		}
+		err = bt_gatt_notify(NULL, &sensor_svc.attrs[1], rec, len);
+		if (err && err != -ENOTCONN) {
+			LOG_DBG("Notify failed (err %d)", err);
+		}
+	}
+}
+
+K_THREAD_DEFINE(ble_export_tid, BLE_THREAD_STACK_SIZE, ble_export_thread,
+		NULL, NULL, NULL, BLE_THREAD_PRIORITY, 0, 0);
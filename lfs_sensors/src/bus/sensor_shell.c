@@ -0,0 +1,185 @@
+/**
+ * @file sensor_shell.c
+ * @brief "sensors" shell command reading the sensor bus on demand.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "sensor_bus.h"
+#if defined(CONFIG_APP_SENSOR_STATS)
+#include "sensor_stats.h"
+#endif
+#if defined(CONFIG_APP_POWER)
+#include "power.h"
+#endif
+#if defined(CONFIG_APP_I2C_SCHED)
+#include "i2c_sched.h"
+#endif
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define SHELL_READ_TIMEOUT	K_MSEC(100)
+
+//==============================================================================
+// Commands
+//==============================================================================
+
+static int cmd_sensors_now(const struct shell *sh, size_t argc, char **argv)
+{
+	hum_temp_sample ht;
+	press_sample lp;
+	imu_sample imu;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	if (zbus_chan_read(&ht_chan, &ht, SHELL_READ_TIMEOUT) == 0 && ht.ts_ns != 0) {
+		shell_print(sh, "ht  @%llu ms: humidity %.2f %%, temperature %.2f C",
+			    ht.ts_ns / NSEC_PER_MSEC, ht.data.humidity, ht.data.temperature);
+	}
+	if (zbus_chan_read(&lp_chan, &lp, SHELL_READ_TIMEOUT) == 0 && lp.ts_ns != 0) {
+		shell_print(sh, "lp  @%llu ms: pressure %.3f kPa",
+			    lp.ts_ns / NSEC_PER_MSEC, lp.data.pressure);
+	}
+	if (zbus_chan_read(&imu_chan, &imu, SHELL_READ_TIMEOUT) == 0 && imu.ts_ns != 0) {
+		shell_print(sh, "imu @%llu ms: accel %.2f %.2f %.2f m/s^2, gyro %.2f %.2f %.2f rad/s",
+			    imu.ts_ns / NSEC_PER_MSEC,
+			    imu.data.accel.x, imu.data.accel.y, imu.data.accel.z,
+			    imu.data.gyro.x, imu.data.gyro.y, imu.data.gyro.z);
+	}
+#if defined(CONFIG_APP_IMU_FUSION)
+	orient_sample orient;
+
+	if (zbus_chan_read(&orient_chan, &orient, SHELL_READ_TIMEOUT) == 0 && orient.ts_ns != 0) {
+		shell_print(sh, "ori @%llu ms: roll %.1f pitch %.1f yaw %.1f deg, "
+			    "q [%.4f %.4f %.4f %.4f]", orient.ts_ns / NSEC_PER_MSEC,
+			    (double)orient.roll, (double)orient.pitch, (double)orient.yaw,
+			    (double)orient.q[0], (double)orient.q[1], (double)orient.q[2],
+			    (double)orient.q[3]);
+	}
+#endif
+#if defined(CONFIG_APP_VIBRATION)
+	vib_sample vib;
+
+	if (zbus_chan_read(&vib_chan, &vib, SHELL_READ_TIMEOUT) == 0 && vib.ts_ns != 0) {
+		shell_print(sh, "vib @%llu ms: rms %.3f m/s^2, peak %.1f Hz, "
+			    "bands %.3f %.3f %.3f %.3f", vib.ts_ns / NSEC_PER_MSEC,
+			    (double)vib.features.rms, (double)vib.features.peak_hz,
+			    (double)vib.features.band_rms[0], (double)vib.features.band_rms[1],
+			    (double)vib.features.band_rms[2], (double)vib.features.band_rms[3]);
+	}
+#endif
+#if defined(CONFIG_APP_ANOMALY)
+	static const char *const sources[] = { "humidity", "temperature", "pressure",
+					       "accel", "jerk" };
+	anomaly_event ev;
+
+	if (zbus_chan_read(&anomaly_chan, &ev, SHELL_READ_TIMEOUT) == 0 && ev.ts_ns != 0) {
+		shell_print(sh, "last anomaly @%llu ms: %s value %.3f score %.2f",
+			    ev.ts_ns / NSEC_PER_MSEC,
+			    ev.source < ARRAY_SIZE(sources) ? sources[ev.source] : "?",
+			    (double)ev.value, (double)ev.score);
+	}
+#endif
+	return 0;
+}
+
+#if defined(CONFIG_APP_SENSOR_STATS)
+static int cmd_sensors_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	struct sensor_rollup r;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	for (int ch = 0; ch < SENSOR_STATS_CHAN_COUNT; ch++) {
+		if (sensor_stats_last(ch, &r) < 0) {
+			shell_print(sh, "%s: no completed window yet", sensor_stats_name(ch));
+			continue;
+		}
+		shell_print(sh, "%s: %u samples over %llu ms", sensor_stats_name(ch), r.count,
+			    (r.end_ns - r.start_ns) / NSEC_PER_MSEC);
+		for (size_t i = 0; i < sensor_stats_nvals(ch); i++) {
+			shell_print(sh, "  %-12s min %10.3f  mean %10.3f  max %10.3f",
+				    sensor_stats_label(ch, i), r.min[i], r.sum[i] / r.count,
+				    r.max[i]);
+		}
+	}
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_APP_POWER)
+static int cmd_sensors_power(const struct shell *sh, size_t argc, char **argv)
+{
+	uint64_t now_ns = sensor_timestamp_ns();
+	struct power_dom_stats st;
+	int idle = power_cpu_idle_permille();
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	shell_print(sh, "Duty cycle over %llu s", now_ns / NSEC_PER_SEC);
+	for (int d = 0; d < POWER_DOM_COUNT; d++) {
+		power_stats(d, &st);
+		shell_print(sh, "  %-8s %8.3f %% on  %8u wakeups", power_dom_name(d),
+			    100.0 * st.active_ns / now_ns, st.wakeups);
+	}
+	if (idle >= 0) {
+		shell_print(sh, "  cpu      %8.1f %% idle", idle / 10.0);
+	}
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_APP_I2C_SCHED)
+static int cmd_sensors_i2c(const struct shell *sh, size_t argc, char **argv)
+{
+	uint64_t now_ns = sensor_timestamp_ns();
+	struct i2c_sched_stats st;
+	struct i2c_job_stats js;
+	const char *name;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	i2c_sched_stats(&st);
+	shell_print(sh, "Bus %.3f %% busy over %llu s, %u batches, %.2f jobs per batch, max %u",
+		    100.0 * st.busy_ns / now_ns, now_ns / NSEC_PER_SEC, st.batches,
+		    st.batches ? (double)st.jobs / st.batches : 0.0, st.batch_max);
+	for (int i = 0; i2c_sched_job_stats(i, &name, &js) == 0; i++) {
+		if (js.runs == 0) {
+			continue;
+		}
+		shell_print(sh, "  %-8s %8u runs  %6llu us on bus  wait %6llu us avg %6llu us max"
+			    "  %u errors", name, js.runs, js.busy_ns / NSEC_PER_USEC / js.runs,
+			    js.wait_ns / NSEC_PER_USEC / js.runs, js.wait_max_ns / NSEC_PER_USEC,
+			    js.errors);
+	}
+	return 0;
+}
+#endif
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sensors_cmds,
+	SHELL_CMD(now, NULL, "Latest sample of every channel", cmd_sensors_now),
+#if defined(CONFIG_APP_SENSOR_STATS)
+	SHELL_CMD(stats, NULL, "Last completed rollup window", cmd_sensors_stats),
+#endif
+#if defined(CONFIG_APP_POWER)
+	SHELL_CMD(power, NULL, "Duty cycle of sensors, bus, flash and CPU", cmd_sensors_power),
+#endif
+#if defined(CONFIG_APP_I2C_SCHED)
+	SHELL_CMD(i2c, NULL, "Sensor bus utilisation and waiting time", cmd_sensors_i2c),
+#endif
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(sensors, &sensors_cmds, "Sensor data bus", NULL);
@@ -0,0 +1,207 @@
+/**
+ * @file sensor_stats.c
+ * @brief Rollup engine subscribed to the sensor data bus.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/zbus/zbus.h>
+#include <errno.h>
+#include <float.h>
+
+#include "sensor_bus.h"
+#include "sensor_stats.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(sensor_stats, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define STATS_THREAD_PRIORITY		7
+#define STATS_THREAD_STACK_SIZE		1024
+#define STATS_QUEUE_LEN			8
+#define STATS_WINDOW_MS			(CONFIG_APP_SENSOR_STATS_WINDOW_S * MSEC_PER_SEC)
+
+//==============================================================================
+// Channel Table
+//==============================================================================
+
+struct stats_channel {
+	const struct zbus_channel *chan;
+	const char *name;
+	size_t nvals;
+	const char *const *labels;
+	struct sensor_rollup cur;
+	struct sensor_rollup last;
+};
+
+static const char *const ht_labels[] = { "humidity", "temperature" };
+static const char *const lp_labels[] = { "pressure" };
+static const char *const imu_labels[] = {
+	"accel_x", "accel_y", "accel_z", "gyro_x", "gyro_y", "gyro_z",
+};
+
+static struct stats_channel channels[SENSOR_STATS_CHAN_COUNT] = {
+	[SENSOR_STATS_HT] = { &ht_chan, "ht", ARRAY_SIZE(ht_labels), ht_labels },
+	[SENSOR_STATS_LP] = { &lp_chan, "lp", ARRAY_SIZE(lp_labels), lp_labels },
+	[SENSOR_STATS_IMU] = { &imu_chan, "imu", ARRAY_SIZE(imu_labels), imu_labels },
+};
+
+BUILD_ASSERT(ARRAY_SIZE(ht_labels) == sizeof(hum_temp_data) / sizeof(double));
+BUILD_ASSERT(ARRAY_SIZE(lp_labels) == sizeof(press_data) / sizeof(double));
+BUILD_ASSERT(ARRAY_SIZE(imu_labels) == sizeof(imu_sensor_data) / sizeof(double));
+
+/* Protects the completed rollups read by the shell */
+static struct k_spinlock last_lock;
+
+//==============================================================================
+// Subscriber
+//==============================================================================
+
+ZBUS_SUBSCRIBER_DEFINE(stats_sub, STATS_QUEUE_LEN);
+ZBUS_CHAN_ADD_OBS(ht_chan, stats_sub, 1);
+ZBUS_CHAN_ADD_OBS(lp_chan, stats_sub, 1);
+ZBUS_CHAN_ADD_OBS(imu_chan, stats_sub, 1);
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+static void rollup_reset(struct sensor_rollup *r, size_t nvals)
+{
+	r->count = 0;
+	for (size_t i = 0; i < nvals; i++) {
+		r->min[i] = DBL_MAX;
+		r->max[i] = -DBL_MAX;
+		r->sum[i] = 0.0;
+	}
+}
+
+/**
+ * @brief Fold the sample currently held by the channel into the window.
+ *
+ * The channel is claimed so the sample is read in place.
+ */
+static void rollup_add(struct stats_channel *sc)
+{
+	const uint64_t *msg;
+	const double *vals;
+
+	if (zbus_chan_claim(sc->chan, K_MSEC(100)) < 0) {
+		return;
+	}
+	// Every sample is a timestamp followed by doubles
+	msg = zbus_chan_const_msg(sc->chan);
+	vals = (const double *)&msg[1];
+
+	if (sc->cur.count == 0) {
+		sc->cur.start_ns = msg[0];
+	}
+	sc->cur.end_ns = msg[0];
+	for (size_t i = 0; i < sc->nvals; i++) {
+		sc->cur.min[i] = MIN(sc->cur.min[i], vals[i]);
+		sc->cur.max[i] = MAX(sc->cur.max[i], vals[i]);
+		sc->cur.sum[i] += vals[i];
+	}
+	sc->cur.count++;
+	zbus_chan_finish(sc->chan);
+}
+
+static void rollup_close(struct stats_channel *sc)
+{
+	k_spinlock_key_t key;
+
+	if (sc->cur.count == 0) {
+		return;
+	}
+	LOG_INF("%s: %u samples, %s mean %.2f [%.2f, %.2f]", sc->name, sc->cur.count,
+		sc->labels[0], sc->cur.sum[0] / sc->cur.count, sc->cur.min[0], sc->cur.max[0]);
+
+	key = k_spin_lock(&last_lock);
+	sc->last = sc->cur;
+	k_spin_unlock(&last_lock, key);
+	rollup_reset(&sc->cur, sc->nvals);
+}
+
+//==============================================================================
+// Thread
+//==============================================================================
+
+static void stats_thread(void *, void *, void *)
+{
+	const struct zbus_channel *chan;
+	int64_t window_end = k_uptime_get() + STATS_WINDOW_MS;
+
+	for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+		rollup_reset(&channels[i].cur, channels[i].nvals);
+	}
+
+	while (1) {
+		int64_t left = window_end - k_uptime_get();
+
+		if (left > 0 && zbus_sub_wait(&stats_sub, &chan, K_MSEC(left)) == 0) {
+			for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+				if (channels[i].chan == chan) {
+					rollup_add(&channels[i]);
+				}
+			}
+			continue;
+		}
+
+		for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+			rollup_close(&channels[i]);
+		}
+		window_end += STATS_WINDOW_MS;
+	}
+}
+
+K_THREAD_DEFINE(sensor_stats_tid, STATS_THREAD_STACK_SIZE, stats_thread,
+		NULL, NULL, NULL, STATS_THREAD_PRIORITY, 0, 0);
+
+//==============================================================================
+// Function Definitions
+//==============================================================================
+
+int sensor_stats_last(enum sensor_stats_chan ch, struct sensor_rollup *out)
+{
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	if (ch >= SENSOR_STATS_CHAN_COUNT) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&last_lock);
+	if (channels[ch].last.count == 0) {
+		ret = -EAGAIN;
+	} else {
+		*out = channels[ch].last;
+	}
+	k_spin_unlock(&last_lock, key);
+	return ret;
+}
+
+const char *sensor_stats_name(enum sensor_stats_chan ch)
+{
+	return ch < SENSOR_STATS_CHAN_COUNT ? channels[ch].name : "?";
+}
+
+size_t sensor_stats_nvals(enum sensor_stats_chan ch)
+{
+	return ch < SENSOR_STATS_CHAN_COUNT ? channels[ch].nvals : 0;
+}
+
+const char *sensor_stats_label(enum sensor_stats_chan ch, size_t i)
+{
+	return i < sensor_stats_nvals(ch) ? channels[ch].labels[i] : "?";
+}
@@ -0,0 +1,50 @@
+/**
+ * @file sensor_stats.h
+ * @brief Windowed min/max/mean rollups of every sensor channel.
+ *
+ * A zbus subscriber with its own thread: on every notification it claims
+ * the channel and folds the latest sample into the running window without
+ * copying it out.
+ */
+
+#ifndef SENSOR_STATS_H
+#define SENSOR_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SENSOR_STATS_MAX_VALUES	6
+
+enum sensor_stats_chan {
+	SENSOR_STATS_HT,
+	SENSOR_STATS_LP,
+	SENSOR_STATS_IMU,
+	SENSOR_STATS_CHAN_COUNT,
+};
+
+struct sensor_rollup {
+	uint32_t count;
+	uint64_t start_ns;
+	uint64_t end_ns;
+	double min[SENSOR_STATS_MAX_VALUES];
+	double max[SENSOR_STATS_MAX_VALUES];
+	double sum[SENSOR_STATS_MAX_VALUES];
+};
+
+/**
+ * @brief Copy the last completed rollup of a channel.
+ *
+ * Returns: 0 on success, -EAGAIN before the first window has completed.
+ */
+int sensor_stats_last(enum sensor_stats_chan ch, struct sensor_rollup *out);
+
+/** Channel name */
+const char *sensor_stats_name(enum sensor_stats_chan ch);
+
+/** Number of values of a channel */
+size_t sensor_stats_nvals(enum sensor_stats_chan ch);
+
+/** Name of value i of a channel */
+const char *sensor_stats_label(enum sensor_stats_chan ch, size_t i);
+
+#endif /* SENSOR_STATS_H */
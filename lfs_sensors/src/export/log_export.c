@@ -0,0 +1,428 @@
+/**
+ * @file log_export.c
+ * @brief Binary log export over a dedicated UART.
+ *
+ * The shell and logging keep the console UART; recorded sensor logs are
+ * pulled off the board through the UART chosen as app,export-uart using a
+ * COBS framed, CRC16 protected request/response protocol (see log_export.h).
+ * Received bytes are deframed on the UART RX thread, requests are served by
+ * the export thread and long transfers use STREAM with a window of DATA
+ * frames the host releases with ACKs, so the link runs at full baud rate
+ * without the host having to poll every chunk.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log_export.h"
+#include "uart_frame.h"
+#include "uart_line_rx.h"
+#include "uart_tx.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(log_export, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#if !DT_HAS_CHOSEN(app_export_uart)
+#error "CONFIG_APP_EXPORT needs a chosen app,export-uart node in the board overlay"
+#endif
+
+#define EXPORT_MNT			"/lfs"
+#define EXPORT_PATH_MAX			32
+
+#define EXPORT_MAX_PAYLOAD		CONFIG_APP_EXPORT_MAX_PAYLOAD
+#define EXPORT_HDR_SIZE			2	/* opcode, sequence */
+#define EXPORT_DATA_HDR_SIZE		(EXPORT_HDR_SIZE + sizeof(uint32_t))
+#define EXPORT_CHUNK_SIZE		(EXPORT_MAX_PAYLOAD - EXPORT_DATA_HDR_SIZE)
+#define EXPORT_FRAME_SIZE		UART_FRAME_ENCODED_MAX(EXPORT_MAX_PAYLOAD)
+
+#define EXPORT_THREAD_STACK_SIZE	(2*1024)
+#define EXPORT_THREAD_PRIORITY		6
+
+//==============================================================================
+// Request Queue
+//==============================================================================
+
+struct export_req {
+	uint16_t len;
+	uint8_t data[EXPORT_MAX_PAYLOAD];
+};
+
+K_MSGQ_DEFINE(export_req_msgq, sizeof(struct export_req), 2, 4);
+
+static const struct device *const export_dev = DEVICE_DT_GET(DT_CHOSEN(app_export_uart));
+
+static struct uart_frame_decoder rx_decoder;
+static uint8_t rx_frame_buf[EXPORT_FRAME_SIZE];
+
+static uint8_t tx_payload[EXPORT_MAX_PAYLOAD];
+static uint8_t tx_frame[EXPORT_FRAME_SIZE];
+
+/* STREAM flow control, written by the RX thread and read by the export thread */
+static atomic_t stream_acked;
+static K_SEM_DEFINE(stream_ack_sem, 0, 1);
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+/**
+ * @brief Frame and transmit tx_payload.
+ *
+ * Input: len	Payload length including the opcode and sequence bytes.
+ *
+ * Returns: 0  Success
+ *	   <0  Error code
+ */
+static int export_send(size_t len)
+{
+	int n = uart_frame_encode(tx_payload, len, tx_frame, sizeof(tx_frame));
+	size_t sent = 0;
+
+	if (n < 0) {
+		return n;
+	}
+
+	/* uart_tx_write blocks up to CONFIG_APP_UART_TX_BLOCK_TIMEOUT_MS per call */
+	while (sent < n) {
+		size_t w = uart_tx_write(tx_frame + sent, n - sent);
+
+		if (w == 0) {
+			LOG_WRN("TX stalled, frame dropped");
+			return -EAGAIN;
+		}
+		sent += w;
+	}
+	return 0;
+}
+
+static uint8_t *export_rsp_begin(uint8_t op, uint8_t seq)
+{
+	tx_payload[0] = op;
+	tx_payload[1] = seq;
+	return &tx_payload[EXPORT_HDR_SIZE];
+}
+
+static void export_send_error(uint8_t op, uint8_t seq, int err)
+{
+	uint8_t *body = export_rsp_begin(EXPORT_OP_ERROR, seq);
+
+	body[0] = op;
+	sys_put_le16((uint16_t)(int16_t)err, &body[1]);
+	export_send(EXPORT_HDR_SIZE + 3);
+}
+
+/**
+ * @brief Build the absolute path of a log file from a request name.
+ *
+ * Only plain file names inside the mount point are accepted.
+ *
+ * Returns: 0  Success
+ *	   -EINVAL  Empty, too long or not a plain name
+ */
+static int export_path(const uint8_t *name, size_t len, char *path)
+{
+	if (len == 0 || len > EXPORT_PATH_MAX - sizeof(EXPORT_MNT "/") ||
+	    memchr(name, '/', len) != NULL || memchr(name, '\0', len) != NULL ||
+	    (name[0] == '.')) {
+		return -EINVAL;
+	}
+	snprintf(path, EXPORT_PATH_MAX, EXPORT_MNT "/%.*s", (int)len, (const char *)name);
+	return 0;
+}
+
+//==============================================================================
+// Request Handlers
+//==============================================================================
+
+static void export_ping(uint8_t seq)
+{
+	uint8_t *body = export_rsp_begin(EXPORT_OP_RSP | EXPORT_OP_PING, seq);
+
+	sys_put_le16(EXPORT_PROTO_VERSION, &body[0]);
+	sys_put_le16(EXPORT_MAX_PAYLOAD, &body[2]);
+	export_send(EXPORT_HDR_SIZE + 4);
+}
+
+/**
+ * @brief List files from a start index, as many as fit one response.
+ *
+ * An empty response tells the host the listing is complete.
+ */
+static void export_list(uint8_t seq, const uint8_t *body, size_t len)
+{
+	struct fs_dir_t dir;
+	struct fs_dirent entry;
+	uint16_t start, index = 0;
+	size_t pos = EXPORT_HDR_SIZE;
+	int rc;
+
+	if (len < 2) {
+		export_send_error(EXPORT_OP_LIST, seq, -EINVAL);
+		return;
+	}
+	start = sys_get_le16(body);
+
+	fs_dir_t_init(&dir);
+	rc = fs_opendir(&dir, EXPORT_MNT);
+	if (rc < 0) {
+		export_send_error(EXPORT_OP_LIST, seq, rc);
+		return;
+	}
+
+	export_rsp_begin(EXPORT_OP_RSP | EXPORT_OP_LIST, seq);
+	while (fs_readdir(&dir, &entry) == 0 && entry.name[0] != '\0') {
+		size_t name_len = strlen(entry.name);
+
+		if (entry.type != FS_DIR_ENTRY_FILE || index++ < start) {
+			continue;
+		}
+		if (pos + 5 + name_len > sizeof(tx_payload)) {
+			break;
+		}
+		sys_put_le32(entry.size, &tx_payload[pos]);
+		tx_payload[pos + 4] = name_len;
+		memcpy(&tx_payload[pos + 5], entry.name, name_len);
+		pos += 5 + name_len;
+	}
+	fs_closedir(&dir);
+
+	export_send(pos);
+}
+
+static void export_read(uint8_t seq, const uint8_t *body, size_t len)
+{
+	struct fs_file_t file;
+	char path[EXPORT_PATH_MAX];
+	uint32_t offset;
+	uint16_t count;
+	uint8_t *data;
+	ssize_t n;
+
+	if (len < 6 || export_path(&body[6], len - 6, path) < 0) {
+		export_send_error(EXPORT_OP_READ, seq, -EINVAL);
+		return;
+	}
+	offset = sys_get_le32(&body[0]);
+	count = MIN(sys_get_le16(&body[4]), EXPORT_CHUNK_SIZE);
+
+	fs_file_t_init(&file);
+	n = fs_open(&file, path, FS_O_READ);
+	if (n == 0) {
+		n = fs_seek(&file, offset, FS_SEEK_SET);
+		if (n == 0) {
+			data = export_rsp_begin(EXPORT_OP_RSP | EXPORT_OP_READ, seq);
+			sys_put_le32(offset, data);
+			n = fs_read(&file, data + sizeof(uint32_t), count);
+		}
+		fs_close(&file);
+	}
+	if (n < 0) {
+		export_send_error(EXPORT_OP_READ, seq, n);
+		return;
+	}
+	export_send(EXPORT_DATA_HDR_SIZE + n);
+}
+
+/**
+ * @brief Stream a file from an offset.
+ *
+ * Keeps at most window DATA frames unacknowledged. A new request arriving
+ * from the host aborts the stream, which is how the host restarts from its
+ * last good offset after a lost or corrupted frame.
+ */
+static void export_stream(uint8_t seq, const uint8_t *body, size_t len)
+{
+	struct fs_file_t file;
+	char path[EXPORT_PATH_MAX];
+	uint32_t offset;
+	uint8_t window;
+	uint8_t *data;
+	ssize_t n;
+	int rc;
+
+	if (len < 5 || export_path(&body[5], len - 5, path) < 0) {
+		export_send_error(EXPORT_OP_STREAM, seq, -EINVAL);
+		return;
+	}
+	offset = sys_get_le32(&body[0]);
+	window = CLAMP(body[4], 1, CONFIG_APP_EXPORT_WINDOW_MAX);
+
+	fs_file_t_init(&file);
+	rc = fs_open(&file, path, FS_O_READ);
+	if (rc == 0) {
+		rc = fs_seek(&file, offset, FS_SEEK_SET);
+		if (rc < 0) {
+			fs_close(&file);
+		}
+	}
+	if (rc < 0) {
+		export_send_error(EXPORT_OP_STREAM, seq, rc);
+		return;
+	}
+
+	atomic_set(&stream_acked, offset);
+	k_sem_reset(&stream_ack_sem);
+
+	while (k_msgq_num_used_get(&export_req_msgq) == 0) {
+		/* Window full: wait for the host to acknowledge */
+		if (offset - (uint32_t)atomic_get(&stream_acked) >= window * EXPORT_CHUNK_SIZE) {
+			if (k_sem_take(&stream_ack_sem, K_MSEC(CONFIG_APP_EXPORT_ACK_TIMEOUT_MS)) != 0) {
+				LOG_WRN("Stream of %s stalled at %u", path, offset);
+				rc = -ETIMEDOUT;
+				break;
+			}
+			continue;
+		}
+
+		data = export_rsp_begin(EXPORT_OP_DATA, seq);
+		sys_put_le32(offset, data);
+		n = fs_read(&file, data + sizeof(uint32_t), EXPORT_CHUNK_SIZE);
+		if (n <= 0) {
+			rc = n;
+			break;
+		}
+		rc = export_send(EXPORT_DATA_HDR_SIZE + n);
+		if (rc < 0) {
+			break;
+		}
+		offset += n;
+	}
+	fs_close(&file);
+
+	if (rc < 0) {
+		export_send_error(EXPORT_OP_STREAM, seq, rc);
+		return;
+	}
+	data = export_rsp_begin(EXPORT_OP_END, seq);
+	sys_put_le32(offset, data);
+	export_send(EXPORT_DATA_HDR_SIZE);
+}
+
+//==============================================================================
+// Receive Path
+//==============================================================================
+
+/*
+ * Runs on the UART RX thread. ACKs are consumed here so they can release the
+ * window while the export thread is busy streaming; everything else is
+ * queued for the export thread.
+ */
+static void export_frame_received(uint8_t *payload, size_t len, void *user_data)
+{
+	struct export_req req;
+
+	ARG_UNUSED(user_data);
+
+	if (len < EXPORT_HDR_SIZE) {
+		return;
+	}
+	if (payload[0] == EXPORT_OP_ACK) {
+		if (len >= EXPORT_DATA_HDR_SIZE) {
+			atomic_set(&stream_acked, sys_get_le32(&payload[EXPORT_HDR_SIZE]));
+			k_sem_give(&stream_ack_sem);
+		}
+		return;
+	}
+
+	req.len = len;
+	memcpy(req.data, payload, len);
+	if (k_msgq_put(&export_req_msgq, &req, K_NO_WAIT) != 0) {
+		LOG_WRN("Request 0x%02x dropped, export busy", payload[0]);
+	}
+}
+
+static void export_rx(const uint8_t *data, size_t len)
+{
+	uart_frame_decoder_feed(&rx_decoder, data, len, export_frame_received, NULL);
+}
+
+//==============================================================================
+// Thread Definition
+//==============================================================================
+
+static K_SEM_DEFINE(export_ready_sem, 0, 1);
+
+static void export_thread(void *, void *, void *)
+{
+	static struct export_req req;
+
+	k_sem_take(&export_ready_sem, K_FOREVER);
+	LOG_INF("Export thread started on %s", export_dev->name);
+
+	while (1) {
+		k_msgq_get(&export_req_msgq, &req, K_FOREVER);
+
+		uint8_t op = req.data[0];
+		uint8_t seq = req.data[1];
+		const uint8_t *body = &req.data[EXPORT_HDR_SIZE];
+		size_t len = req.len - EXPORT_HDR_SIZE;
+
+		switch (op) {
+		case EXPORT_OP_PING:
+			export_ping(seq);
+			break;
+		case EXPORT_OP_LIST:
+			export_list(seq, body, len);
+			break;
+		case EXPORT_OP_READ:
+			export_read(seq, body, len);
+			break;
+		case EXPORT_OP_STREAM:
+			export_stream(seq, body, len);
+			break;
+		default:
+			export_send_error(op, seq, -ENOTSUP);
+			break;
+		}
+	}
+}
+
+K_THREAD_DEFINE(export_tid, EXPORT_THREAD_STACK_SIZE, export_thread,
+		NULL, NULL, NULL,
+		EXPORT_THREAD_PRIORITY, 0, 0);
+
+//==============================================================================
+// Export Initialization
+//==============================================================================
+
+int log_export_init(void)
+{
+	int rc;
+
+	if (!device_is_ready(export_dev)) {
+		LOG_ERR("Export UART %s not ready", export_dev->name);
+		return -ENODEV;
+	}
+
+	uart_frame_decoder_init(&rx_decoder, rx_frame_buf, sizeof(rx_frame_buf));
+
+	rc = uart_tx_init(export_dev);
+	if (rc == 0) {
+		rc = uart_line_rx_start_raw(export_dev, export_rx);
+	}
+	if (rc < 0) {
+		LOG_ERR("Export UART setup failed: %d", rc);
+		return rc;
+	}
+
+	k_sem_give(&export_ready_sem);
+	return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file log_export.h
+ * @brief Binary log export over a dedicated UART.
+ *
+ * Frames are COBS encoded with a CRC16 trailer (see common/uart/uart_frame.h).
+ * Every payload starts with an opcode byte and a sequence byte; responses
+ * echo the request sequence and set EXPORT_OP_RSP in the opcode. All
+ * multi-byte fields are little endian.
+ *
+ *  PING    -                               -> version u16, max payload u16
+ *  LIST    start index u16                 -> { size u32, name len u8, name }...
+ *  READ    offset u32, len u16, name       -> offset u32, data
+ *  STREAM  offset u32, window u8, name     -> DATA { offset u32, data }...
+ *                                             then END { total u32 }
+ *  ACK     next offset u32                 (no response, releases the window)
+ *
+ * Errors are returned as EXPORT_OP_ERROR { request op u8, errno i16 }.
+ */
+
+#ifndef LOG_EXPORT_H
+#define LOG_EXPORT_H
+
+#define EXPORT_PROTO_VERSION	1
+
+enum export_op {
+	EXPORT_OP_PING		= 0x01,
+	EXPORT_OP_LIST		= 0x02,
+	EXPORT_OP_READ		= 0x03,
+	EXPORT_OP_STREAM	= 0x04,
+	EXPORT_OP_ACK		= 0x05,
+
+	EXPORT_OP_RSP		= 0x80,
+	EXPORT_OP_DATA		= EXPORT_OP_RSP | EXPORT_OP_STREAM,
+	EXPORT_OP_END		= 0x86,
+	EXPORT_OP_ERROR		= 0xFF,
+};
+
+/**
+ * @brief Start the export protocol on the chosen app,export-uart.
+ *
+ * Must be called after the LittleFS partition is mounted.
+ *
+ * Returns: 0  Success
+ *	   <0  Error code
+ */
+int log_export_init(void);
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ * @file ahrs.c
+ * @brief Madgwick and Mahony attitude filters, IMU (gyro + accel) variants.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <math.h>
+
+#include "ahrs.h"
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define RAD_TO_DEG		57.29577951f
+
+#if defined(CONFIG_APP_FUSION_MADGWICK)
+#define MADGWICK_BETA		(CONFIG_APP_FUSION_MADGWICK_BETA_MILLI / 1000.0f)
+#else
+#define MAHONY_KP		(CONFIG_APP_FUSION_MAHONY_KP_MILLI / 1000.0f)
+#define MAHONY_KI		(CONFIG_APP_FUSION_MAHONY_KI_MILLI / 1000.0f)
+#endif
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+static void quat_normalize(float q[4])
+{
+	float n = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+	if (n > 0.0f) {
+		float inv = 1.0f / n;
+
+		for (int i = 0; i < 4; i++) {
+			q[i] *= inv;
+		}
+	}
+}
+
+/**
+ * @brief Unit accelerometer vector.
+ *
+ * Returns: false in free fall (no usable gravity reference).
+ */
+static bool accel_unit(const float accel[3], float a[3])
+{
+	float n = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+
+	if (n < 1e-6f) {
+		return false;
+	}
+	for (int i = 0; i < 3; i++) {
+		a[i] = accel[i] / n;
+	}
+	return true;
+}
+
+/**
+ * @brief Seed roll and pitch from gravity, yaw starts at zero.
+ */
+static void seed_from_gravity(struct ahrs *f, const float a[3])
+{
+	float roll = atan2f(a[1], a[2]);
+	float pitch = atan2f(-a[0], sqrtf(a[1] * a[1] + a[2] * a[2]));
+	float cr = cosf(roll / 2), sr = sinf(roll / 2);
+	float cp = cosf(pitch / 2), sp = sinf(pitch / 2);
+
+	f->q[0] = cr * cp;
+	f->q[1] = sr * cp;
+	f->q[2] = cr * sp;
+	f->q[3] = -sr * sp;
+	f->init = true;
+}
+
+#if defined(CONFIG_APP_FUSION_MADGWICK)
+/*
+ * Madgwick: gradient descent step on the gravity error, weighted by beta
+ * against the gyroscope integration
+ */
+static void filter_step(struct ahrs *f, const float g[3], const float a[3], bool have_a, float dt)
+{
+	float *q = f->q;
+	float qdot[4] = {
+		0.5f * (-q[1] * g[0] - q[2] * g[1] - q[3] * g[2]),
+		0.5f * (q[0] * g[0] + q[2] * g[2] - q[3] * g[1]),
+		0.5f * (q[0] * g[1] - q[1] * g[2] + q[3] * g[0]),
+		0.5f * (q[0] * g[2] + q[1] * g[1] - q[2] * g[0]),
+	};
+
+	if (have_a) {
+		float _2q0 = 2.0f * q[0], _2q1 = 2.0f * q[1];
+		float _2q2 = 2.0f * q[2], _2q3 = 2.0f * q[3];
+		float _4q0 = 4.0f * q[0], _4q1 = 4.0f * q[1], _4q2 = 4.0f * q[2];
+		float _8q1 = 8.0f * q[1], _8q2 = 8.0f * q[2];
+		float q0q0 = q[0] * q[0], q1q1 = q[1] * q[1];
+		float q2q2 = q[2] * q[2], q3q3 = q[3] * q[3];
+		float s[4] = {
+			_4q0 * q2q2 + _2q2 * a[0] + _4q0 * q1q1 - _2q1 * a[1],
+			_4q1 * q3q3 - _2q3 * a[0] + 4.0f * q0q0 * q[1] - _2q0 * a[1] - _4q1 +
+				_8q1 * q1q1 + _8q1 * q2q2 + _4q1 * a[2],
+			4.0f * q0q0 * q[2] + _2q0 * a[0] + _4q2 * q3q3 - _2q3 * a[1] - _4q2 +
+				_8q2 * q1q1 + _8q2 * q2q2 + _4q2 * a[2],
+			4.0f * q1q1 * q[3] - _2q1 * a[0] + 4.0f * q2q2 * q[3] - _2q2 * a[1],
+		};
+
+		quat_normalize(s);
+		for (int i = 0; i < 4; i++) {
+			qdot[i] -= MADGWICK_BETA * s[i];
+		}
+	}
+
+	for (int i = 0; i < 4; i++) {
+		q[i] += qdot[i] * dt;
+	}
+}
+#else
+/*
+ * Mahony: PI feedback of the error between measured and estimated gravity
+ * into the gyroscope rate
+ */
+static void filter_step(struct ahrs *f, const float g[3], const float a[3], bool have_a, float dt)
+{
+	float *q = f->q;
+	float gx = g[0], gy = g[1], gz = g[2];
+	float qa, qb, qc;
+
+	if (have_a) {
+		// Estimated gravity direction
+		float vx = q[1] * q[3] - q[0] * q[2];
+		float vy = q[0] * q[1] + q[2] * q[3];
+		float vz = q[0] * q[0] - 0.5f + q[3] * q[3];
+		// Error is the cross product of measured and estimated
+		float ex = a[1] * vz - a[2] * vy;
+		float ey = a[2] * vx - a[0] * vz;
+		float ez = a[0] * vy - a[1] * vx;
+
+		if (MAHONY_KI > 0.0f) {
+			f->integral[0] += 2.0f * MAHONY_KI * ex * dt;
+			f->integral[1] += 2.0f * MAHONY_KI * ey * dt;
+			f->integral[2] += 2.0f * MAHONY_KI * ez * dt;
+			gx += f->integral[0];
+			gy += f->integral[1];
+			gz += f->integral[2];
+		}
+		gx += 2.0f * MAHONY_KP * ex;
+		gy += 2.0f * MAHONY_KP * ey;
+		gz += 2.0f * MAHONY_KP * ez;
+	}
+
+	gx *= 0.5f * dt;
+	gy *= 0.5f * dt;
+	gz *= 0.5f * dt;
+	qa = q[0];
+	qb = q[1];
+	qc = q[2];
+	q[0] += -qb * gx - qc * gy - q[3] * gz;
+	q[1] += qa * gx + qc * gz - q[3] * gy;
+	q[2] += qa * gy - qb * gz + q[3] * gx;
+	q[3] += qa * gz + qb * gy - qc * gx;
+}
+#endif
+
+//==============================================================================
+// Function Definitions
+//==============================================================================
+
+void ahrs_update(struct ahrs *f, const float gyro[3], const float accel[3], float dt)
+{
+	float a[3];
+	bool have_a = accel_unit(accel, a);
+
+	if (!f->init) {
+		if (have_a) {
+			seed_from_gravity(f, a);
+		}
+		return;
+	}
+
+	filter_step(f, gyro, a, have_a, dt);
+	quat_normalize(f->q);
+}
+
+void ahrs_euler(const float q[4], float *roll, float *pitch, float *yaw)
+{
+	float sinp = CLAMP(2.0f * (q[0] * q[2] - q[3] * q[1]), -1.0f, 1.0f);
+
+	*roll = atan2f(2.0f * (q[0] * q[1] + q[2] * q[3]),
+		       1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2])) * RAD_TO_DEG;
+	*pitch = asinf(sinp) * RAD_TO_DEG;
+	*yaw = atan2f(2.0f * (q[0] * q[3] + q[1] * q[2]),
+		      1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3])) * RAD_TO_DEG;
+}
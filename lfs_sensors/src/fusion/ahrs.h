@@ -0,0 +1,37 @@
+/**
+ * @file ahrs.h
+ * @brief 6-axis attitude filter (Madgwick or Mahony, APP_FUSION_FILTER).
+ *
+ * Single precision throughout so it runs on the FPU of Cortex-M4F/M33
+ * parts. Without a magnetometer yaw is relative to the start-up heading
+ * and drifts with the gyroscope bias.
+ */
+
+#ifndef AHRS_H
+#define AHRS_H
+
+#include <stdbool.h>
+
+/* Initialize with q = { 1 }, the first update seeds it from gravity */
+struct ahrs {
+	float q[4];			// Orientation quaternion w, x, y, z
+	float integral[3];		// Mahony integral feedback
+	bool init;			// q seeded from the accelerometer
+};
+
+/**
+ * @brief Advance the filter by one sample.
+ *
+ * Input: f	Filter.
+ *	  gyro	Angular rate in rad/s.
+ *	  accel	Acceleration in any unit, only its direction is used.
+ *	  dt	Time since the previous sample in seconds.
+ */
+void ahrs_update(struct ahrs *f, const float gyro[3], const float accel[3], float dt);
+
+/**
+ * @brief Roll, pitch and yaw of a quaternion in degrees.
+ */
+void ahrs_euler(const float q[4], float *roll, float *pitch, float *yaw);
+
+#endif /* AHRS_H */
@@ -0,0 +1,98 @@
+/**
+ * @file orientation.c
+ * @brief IMU fusion stage between imu_raw_chan and orient_chan.
+ *
+ * A zbus listener on the full rate IMU channel advances the attitude filter
+ * with every sample, in the IMU thread, and publishes the orientation at
+ * APP_FUSION_OUTPUT_HZ.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/zbus/zbus.h>
+#include <string.h>
+
+#include "ahrs.h"
+#include "sensor_bus.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(orientation, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define OUTPUT_PERIOD_NS	(NSEC_PER_SEC / CONFIG_APP_FUSION_OUTPUT_HZ)
+#define NOMINAL_DT		(1.0f / CONFIG_APP_IMU_ODR_HZ)
+#define MAX_DT			(10 * NOMINAL_DT)	// Gap after which dt is not trusted
+
+//==============================================================================
+// State
+//==============================================================================
+
+/* Only touched by the listener, which runs in the single IMU thread */
+static struct ahrs filter = { .q = { 1.0f } };
+static uint64_t last_ts_ns;
+static uint64_t last_out_ns;
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+static void orientation_publish(uint64_t ts_ns)
+{
+	orient_sample out = { .ts_ns = ts_ns };
+
+	memcpy(out.q, filter.q, sizeof(out.q));
+	ahrs_euler(out.q, &out.roll, &out.pitch, &out.yaw);
+
+	if (zbus_chan_pub(&orient_chan, &out, K_NO_WAIT) < 0) {
+		LOG_DBG("orient_chan busy, output dropped");
+		return;
+	}
+	LOG_DBG("roll %.1f pitch %.1f yaw %.1f", (double)out.roll, (double)out.pitch,
+		(double)out.yaw);
+}
+
+/**
+ * @brief zbus listener, runs in the IMU thread for every raw sample.
+ *
+ * Input: chan imu_raw_chan.
+ */
+static void orientation_listener_cb(const struct zbus_channel *chan)
+{
+	const imu_sample *s = zbus_chan_const_msg(chan);
+	const float gyro[3] = { s->data.gyro.x, s->data.gyro.y, s->data.gyro.z };
+	const float accel[3] = { s->data.accel.x, s->data.accel.y, s->data.accel.z };
+	float dt = NOMINAL_DT;
+
+	if (last_ts_ns != 0 && s->ts_ns > last_ts_ns) {
+		dt = (float)(s->ts_ns - last_ts_ns) / NSEC_PER_SEC;
+		if (dt > MAX_DT) {
+			dt = NOMINAL_DT;
+		}
+	}
+	last_ts_ns = s->ts_ns;
+
+	if (!filter.init) {
+		LOG_INF("IMU fusion: %s, output %d Hz",
+			IS_ENABLED(CONFIG_APP_FUSION_MADGWICK) ? "Madgwick" : "Mahony",
+			CONFIG_APP_FUSION_OUTPUT_HZ);
+	}
+	ahrs_update(&filter, gyro, accel, dt);
+
+	if (filter.init && s->ts_ns - last_out_ns >= OUTPUT_PERIOD_NS) {
+		last_out_ns = s->ts_ns;
+		orientation_publish(s->ts_ns);
+	}
+}
+
+ZBUS_LISTENER_DEFINE(orientation_lis, orientation_listener_cb);
+ZBUS_CHAN_ADD_OBS(imu_raw_chan, orientation_lis, 0);
@@ -17,10 +17,16 @@
 #include <zephyr/device.h>
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/i2c.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 #include <errno.h>
 #include <stdint.h>
 
+#include "i2c_sched.h"
+#include "power.h"
+#include "sensor_bus.h"
+
 //==============================================================================
 // Device Tree Bindings
 //==============================================================================
@@ -28,6 +34,7 @@
 #if DT_NODE_EXISTS(DT_ALIAS(ht_sensor))
 #define HUM_TEMP_NODE DT_ALIAS(ht_sensor)
 static const struct device *const hts_dev = DEVICE_DT_GET(HUM_TEMP_NODE);
+static const struct device *const hts_bus = DEVICE_DT_GET(DT_BUS(HUM_TEMP_NODE));
 #else
 #error("Humidity-Temperature sensor not found in device tree.")
 #endif
@@ -42,57 +49,135 @@ LOG_MODULE_REGISTER(hum_temp, CONFIG_APP_LOG_LEVEL);
 // Configuration Constants
 //==============================================================================
 
-#define MAX_MSGS              	10     // Maximum number of sensor samples in queue
-#define MSGQ_ALIGN            	32     // Align message queue entries
 #define HT_SENSOR_PRIORITY	5	// Thread priority for sensor task
-#define HT_THREAD_STACK_SIZE  	512    // Stack size for sensor thread
+#define HT_THREAD_STACK_SIZE  	1024   // Stack size for sensor thread, zbus listeners run on it
+#define HT_PERIOD_MS		5000	// Sampling period
 
 //==============================================================================
-// Sensor-data structure
+// Burst Read
 //==============================================================================
 
-typedef struct {
-        double humidity;
-        double temperature;
-} hum_temp_data;
+/*
+ * With the I2C scheduler the HTS221 output registers are read in a single
+ * auto-increment burst and converted here with the factory calibration,
+ * where the driver issues one transaction per channel.
+ */
+#if defined(CONFIG_APP_I2C_SCHED) && DT_NODE_HAS_COMPAT(HUM_TEMP_NODE, st_hts221) && \
+	DT_ON_BUS(HUM_TEMP_NODE, i2c)
+#define HTS_BURST
+
+#define HTS221_AUTO_INC		0x80	// Sub-address MSB, increments the register
+#define HTS221_REG_OUT		0x28	// HUMIDITY_OUT_L .. TEMP_OUT_H
+#define HTS221_REG_CALIB	0x30	// H0_rH_x2 .. T1_OUT_H
 
-//==============================================================================
-// Message Queue
-//==============================================================================
+static const struct i2c_dt_spec hts_i2c = I2C_DT_SPEC_GET(HUM_TEMP_NODE);
 
-// Queue for transferring humidity/temperature readings between threads
-struct k_msgq ht_sensor_msgq;
-K_MSGQ_DEFINE(ht_sensor_msgq, sizeof(hum_temp_data), MAX_MSGS, MSGQ_ALIGN);
+/* Two point calibration of each channel: raw output against value */
+static struct {
+	int16_t h0_out, h1_out;
+	float h0_rh, h1_rh;
+	int16_t t0_out, t1_out;
+	float t0_degc, t1_degc;
+} hts_calib;
+
+static uint8_t hts_raw[4];
+#endif
+
+static struct i2c_job hts_job;
 
 //==============================================================================
 // Function Prototypes
 //==============================================================================
 
-static int hum_temp_process(hum_temp_data* data_struct);
+static int hum_temp_process(hum_temp_sample *sample);
 static void hum_temp_thread(void *, void *, void *);
 
 //==============================================================================
 // Function Definitions
 //==============================================================================
 
+#if defined(HTS_BURST)
+/**
+ * @brief Read the factory calibration, once at start-up.
+ *
+ * Returns: 0 on success, negative error code otherwise.
+ */
+static int hts_calib_load(void)
+{
+	uint8_t c[16];
+	int ret;
+
+	ret = i2c_burst_read_dt(&hts_i2c, HTS221_AUTO_INC | HTS221_REG_CALIB, c, sizeof(c));
+	if (ret < 0) {
+		return ret;
+	}
+
+	hts_calib.h0_rh = c[0] / 2.0f;
+	hts_calib.h1_rh = c[1] / 2.0f;
+	hts_calib.t0_degc = (c[2] | (c[5] & 0x03) << 8) / 8.0f;
+	hts_calib.t1_degc = (c[3] | (c[5] & 0x0c) << 6) / 8.0f;
+	hts_calib.h0_out = sys_get_le16(&c[6]);
+	hts_calib.h1_out = sys_get_le16(&c[10]);
+	hts_calib.t0_out = sys_get_le16(&c[12]);
+	hts_calib.t1_out = sys_get_le16(&c[14]);
+
+	if (hts_calib.h0_out == hts_calib.h1_out || hts_calib.t0_out == hts_calib.t1_out) {
+		return -EIO;
+	}
+	return 0;
+}
+
+/* Linear interpolation through the two calibration points */
+static double hts_convert(int16_t raw, int16_t x0, int16_t x1, float y0, float y1)
+{
+	return y0 + (double)(y1 - y0) * (raw - x0) / (x1 - x0);
+}
+#endif
+
+/**
+ * @brief Bus transfer of a sample, run by the I2C scheduler.
+ */
+static int hts_read(struct i2c_job *job)
+{
+	ARG_UNUSED(job);
+#if defined(HTS_BURST)
+	return i2c_burst_read_dt(&hts_i2c, HTS221_AUTO_INC | HTS221_REG_OUT, hts_raw,
+				 sizeof(hts_raw));
+#else
+	return sensor_sample_fetch(hts_dev);
+#endif
+}
+
 /**
  * @brief Fetch a humidity and temperature sample from the sensor.
  *
- * This function checks readiness, fetches the latest measurement,
- * and converts it to floating-point values stored in data_struct.
+ * This function fetches the latest measurement through the I2C
+ * scheduler, stamps it with the middle of the bus transfer and
+ * converts it to floating-point values stored in the sample.
  *
- * Input: data_struct Pointer to store the fetched temperature & humidity.
+ * Input: sample Pointer to store the fetched temperature & humidity.
  *
  * Returns: 0  Success, value stored in data_struct humidity and temperature elements.
  * 	   -1  Failure, error logged.
  */
 
-int hum_temp_process(hum_temp_data* data_struct){
-	if (sensor_sample_fetch(hts_dev) < 0)
+int hum_temp_process(hum_temp_sample *sample){
+	hum_temp_data *data_struct = &sample->data;
+
+	if (i2c_sched_run(&hts_job) < 0)
 	{
 		LOG_ERR("Faileed to fetch HT sample");
 		return -1;
 	}
+	sample->ts_ns = i2c_job_ts_ns(&hts_job);
+
+#if defined(HTS_BURST)
+	data_struct->humidity = hts_convert(sys_get_le16(&hts_raw[0]), hts_calib.h0_out,
+					    hts_calib.h1_out, hts_calib.h0_rh, hts_calib.h1_rh);
+	data_struct->temperature = hts_convert(sys_get_le16(&hts_raw[2]), hts_calib.t0_out,
+					       hts_calib.t1_out, hts_calib.t0_degc,
+					       hts_calib.t1_degc);
+#else
 	struct sensor_value temp, hum;
 	if (sensor_channel_get(hts_dev, SENSOR_CHAN_AMBIENT_TEMP, &temp) < 0) {
 		LOG_ERR("sensor: %s read temperature channel failed", hts_dev->name);
@@ -107,6 +192,7 @@ int hum_temp_process(hum_temp_data* data_struct){
 	/* Store temperature and humidity readings to the data struct */
 	data_struct->temperature = sensor_value_to_double(&temp);
 	data_struct->humidity = sensor_value_to_double(&hum);
+#endif
 
 	return 0;
 }
@@ -134,8 +220,8 @@ K_THREAD_DEFINE(hum_temp_tid, HT_THREAD_STACK_SIZE, hum_temp_thread,
  * Periodically:
  *  1. Validates sensor readiness.
  *  2. Reads humidity and temperature.
- *  3. Pushes results into the message queue.
- *  4. Sleeps before the next cycle.
+ *  3. Publishes results on the sensor bus.
+ *  4. Sleeps until the next deadline shared with the other sensors.
  */
 
 void hum_temp_thread(void *, void *, void *)
@@ -145,16 +231,47 @@ void hum_temp_thread(void *, void *, void *)
                 return;
         }
 
-	hum_temp_data data_struct;
+	hum_temp_sample sample;
+	int ret;
 	LOG_INF("HT Thread started");
 
+	power_enable(POWER_DOM_BUS, hts_bus);
+	power_enable(POWER_DOM_HT, hts_dev);
+#if defined(CONFIG_APP_POWER_SENSOR_IDLE)
+	/* The driver has no one-shot conversion, run it at its slowest rate */
+	struct sensor_value odr = { .val1 = 1 };
+
+	if (sensor_attr_set(hts_dev, SENSOR_CHAN_ALL, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr) < 0) {
+		LOG_INF("sensor: %s keeps its default rate", hts_dev->name);
+	}
+#endif
+
+	i2c_job_init(&hts_job, "hts221", hts_read);
+#if defined(HTS_BURST)
+	power_get(POWER_DOM_BUS, hts_bus);
+	power_get(POWER_DOM_HT, hts_dev);
+	ret = hts_calib_load();
+	power_put(POWER_DOM_HT, hts_dev);
+	power_put(POWER_DOM_BUS, hts_bus);
+	if (ret < 0) {
+		LOG_ERR("sensor: %s calibration read failed: %d", hts_dev->name, ret);
+		return;
+	}
+#endif
+
 	while (1) 
 	{
-		if (hum_temp_process(&data_struct) == 0){
-			k_msgq_put(&ht_sensor_msgq, &data_struct, K_MSEC(1000));
+		power_get(POWER_DOM_BUS, hts_bus);
+		power_get(POWER_DOM_HT, hts_dev);
+		ret = hum_temp_process(&sample);
+		power_put(POWER_DOM_HT, hts_dev);
+		power_put(POWER_DOM_BUS, hts_bus);
+
+		if (ret == 0){
+			zbus_chan_pub(&ht_chan, &sample, K_MSEC(1000));
 		}
-		LOG_DBG("Humidity: %.2f, Temperature: %.2f", data_struct.humidity, data_struct.temperature);
-		k_sleep(K_MSEC(5000));
+		LOG_DBG("Humidity: %.2f, Temperature: %.2f", sample.data.humidity, sample.data.temperature);
+		k_sleep(K_TIMEOUT_ABS_MS(sensor_next_slot_ms(HT_PERIOD_MS, 0)));
 	}
 
 }
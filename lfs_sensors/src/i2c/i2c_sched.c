@@ -0,0 +1,217 @@
+/**
+ * @file i2c_sched.c
+ * @brief Batched transaction scheduler for the sensor I2C bus.
+ *
+ * Submissions go to a pending list. The scheduler thread wakes on the
+ * first one, waits APP_I2C_SCHED_GROUP_US for the rest of the jobs due at
+ * the same deadline and runs the whole list back to back. Jobs submitted
+ * while a batch runs form the next one.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+
+#include "i2c_sched.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(i2c_sched, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+/*
+ * Same priority as the sensor threads: a submission does not preempt the
+ * other threads woken on the same tick, they all submit before the batch
+ * starts even without a gathering window
+ */
+#define I2C_SCHED_PRIORITY	5
+#define I2C_SCHED_STACK_SIZE	1024	// Driver fetches of non-burst sensors run on it
+
+//==============================================================================
+// Scheduler State
+//==============================================================================
+
+static sys_slist_t pending = SYS_SLIST_STATIC_INIT(&pending);
+static sys_slist_t registered = SYS_SLIST_STATIC_INIT(&registered);
+static struct i2c_sched_stats totals;
+
+/* Guards the lists and every statistic */
+static struct k_spinlock sched_lock;
+
+/* A give may find the batch already taken, the thread then runs nothing */
+static K_SEM_DEFINE(pending_sem, 0, 1);
+
+//==============================================================================
+// Function Definitions
+//==============================================================================
+
+void i2c_job_init(struct i2c_job *job, const char *name, i2c_job_fn fn)
+{
+	k_spinlock_key_t key;
+
+	job->name = name;
+	job->fn = fn;
+	k_sem_init(&job->done, 0, 1);
+
+	key = k_spin_lock(&sched_lock);
+	sys_slist_append(&registered, &job->reg_node);
+	k_spin_unlock(&sched_lock, key);
+}
+
+int i2c_sched_run(struct i2c_job *job)
+{
+	k_spinlock_key_t key = k_spin_lock(&sched_lock);
+
+	job->submit_ns = sensor_timestamp_ns();
+	sys_slist_append(&pending, &job->node);
+	k_spin_unlock(&sched_lock, key);
+
+	k_sem_give(&pending_sem);
+	k_sem_take(&job->done, K_FOREVER);
+	return job->result;
+}
+
+void i2c_sched_stats(struct i2c_sched_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&sched_lock);
+
+	*out = totals;
+	k_spin_unlock(&sched_lock, key);
+}
+
+int i2c_sched_job_stats(int idx, const char **name, struct i2c_job_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&sched_lock);
+	struct i2c_job *job;
+	int ret = -ENOENT;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&registered, job, reg_node) {
+		if (idx-- == 0) {
+			*name = job->name;
+			*out = job->stats;
+			ret = 0;
+			break;
+		}
+	}
+	k_spin_unlock(&sched_lock, key);
+	return ret;
+}
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+/**
+ * @brief Run one job and account it.
+ *
+ * Returns: time the job held the bus in ns.
+ */
+static uint64_t job_exec(struct i2c_job *job)
+{
+	k_spinlock_key_t key;
+	uint64_t wait_ns, busy_ns;
+
+	job->start_ns = sensor_timestamp_ns();
+	job->result = job->fn(job);
+	job->end_ns = sensor_timestamp_ns();
+	wait_ns = job->start_ns - job->submit_ns;
+	busy_ns = job->end_ns - job->start_ns;
+
+	key = k_spin_lock(&sched_lock);
+	job->stats.runs++;
+	job->stats.errors += job->result < 0;
+	job->stats.busy_ns += busy_ns;
+	job->stats.wait_ns += wait_ns;
+	job->stats.wait_max_ns = MAX(job->stats.wait_max_ns, wait_ns);
+	k_spin_unlock(&sched_lock, key);
+
+	return busy_ns;
+}
+
+//==============================================================================
+// Bus Report
+//==============================================================================
+
+static void i2c_sched_report(struct k_work *work)
+{
+	uint64_t now_ns = sensor_timestamp_ns();
+	struct i2c_sched_stats st;
+	struct i2c_job_stats js;
+	const char *name;
+	uint32_t ppm;
+
+	i2c_sched_stats(&st);
+	ppm = st.busy_ns / MAX(now_ns / 1000000, 1);
+	LOG_INF("I2C after %llu s: %u.%03u %% busy, %u batches, %u jobs, at most %u per batch",
+		now_ns / NSEC_PER_SEC, ppm / 10000, ppm % 10000 / 10, st.batches, st.jobs,
+		st.batch_max);
+	for (int i = 0; i2c_sched_job_stats(i, &name, &js) == 0; i++) {
+		if (js.runs == 0) {
+			continue;
+		}
+		LOG_INF("  %-8s %u runs, %llu us on the bus, wait %llu us avg %llu us max, %u errors",
+			name, js.runs, js.busy_ns / NSEC_PER_USEC / js.runs,
+			js.wait_ns / NSEC_PER_USEC / js.runs, js.wait_max_ns / NSEC_PER_USEC,
+			js.errors);
+	}
+
+	k_work_schedule(k_work_delayable_from_work(work), K_SECONDS(CONFIG_APP_I2C_SCHED_REPORT_S));
+}
+
+static K_WORK_DELAYABLE_DEFINE(report_work, i2c_sched_report);
+
+//==============================================================================
+// Thread
+//==============================================================================
+
+static void i2c_sched_thread(void *, void *, void *)
+{
+	k_work_schedule(&report_work, K_SECONDS(CONFIG_APP_I2C_SCHED_REPORT_S));
+
+	while (1) {
+		k_spinlock_key_t key;
+		sys_slist_t batch;
+		struct i2c_job *job, *next;
+		uint64_t busy_ns = 0;
+		uint32_t n = 0;
+
+		k_sem_take(&pending_sem, K_FOREVER);
+		if (CONFIG_APP_I2C_SCHED_GROUP_US > 0) {
+			k_sleep(K_USEC(CONFIG_APP_I2C_SCHED_GROUP_US));
+		}
+
+		key = k_spin_lock(&sched_lock);
+		batch = pending;
+		sys_slist_init(&pending);
+		k_spin_unlock(&sched_lock, key);
+
+		/* A released job may be submitted again, next is read before */
+		SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&batch, job, next, node) {
+			busy_ns += job_exec(job);
+			n++;
+			k_sem_give(&job->done);
+		}
+		if (n == 0) {
+			continue;
+		}
+
+		key = k_spin_lock(&sched_lock);
+		totals.batches++;
+		totals.jobs += n;
+		totals.batch_max = MAX(totals.batch_max, n);
+		totals.busy_ns += busy_ns;
+		k_spin_unlock(&sched_lock, key);
+	}
+}
+
+K_THREAD_DEFINE(i2c_sched_tid, I2C_SCHED_STACK_SIZE, i2c_sched_thread,
+		NULL, NULL, NULL, I2C_SCHED_PRIORITY, 0, 0);
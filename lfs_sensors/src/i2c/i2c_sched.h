@@ -0,0 +1,117 @@
+/**
+ * @file i2c_sched.h
+ * @brief Batched transaction scheduler for the sensor I2C bus.
+ *
+ * Sensor reads are jobs. With APP_I2C_SCHED, i2c_sched_run() hands the job
+ * to the scheduler thread, which gathers the jobs submitted together and
+ * runs them back to back in one batch. The sensor threads wake on shared
+ * deadlines (sensor_next_slot_ms()), so the reads due at the same instant
+ * share a batch instead of interleaving on the bus. The scheduler accounts
+ * bus busy time, batch sizes and the time every job waited for the bus.
+ *
+ * Without APP_I2C_SCHED the job runs at once in the calling thread, so the
+ * sensor modules use the same code either way.
+ *
+ * Callers keep their device and the bus resumed (power_get()) around
+ * i2c_sched_run(). Configuration writes stay on the drivers.
+ */
+
+#ifndef I2C_SCHED_H
+#define I2C_SCHED_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+#include <stdint.h>
+
+#include "sensor_data.h"
+
+struct i2c_job;
+
+/**
+ * @brief Bus transfers of a job, run on the scheduler thread.
+ *
+ * Returns: 0 on success, negative error code otherwise.
+ */
+typedef int (*i2c_job_fn)(struct i2c_job *job);
+
+struct i2c_job_stats {
+	uint32_t runs;
+	uint32_t errors;
+	uint64_t busy_ns;		// Time on the bus, total
+	uint64_t wait_ns;		// Submission to start of the transfer, total
+	uint64_t wait_max_ns;
+};
+
+struct i2c_job {
+	sys_snode_t node;		// Pending batch
+	sys_snode_t reg_node;		// Registered jobs, for the report
+	const char *name;
+	i2c_job_fn fn;
+	struct k_sem done;
+	int result;
+	uint64_t submit_ns;
+	uint64_t start_ns;		// Bus transfer of the last run
+	uint64_t end_ns;
+	struct i2c_job_stats stats;
+};
+
+struct i2c_sched_stats {
+	uint32_t batches;
+	uint32_t jobs;
+	uint32_t batch_max;		// Most jobs in one batch
+	uint64_t busy_ns;		// Time on the bus, total
+};
+
+/**
+ * @brief Middle of the bus transfer of the last run, the sample timestamp.
+ */
+static inline uint64_t i2c_job_ts_ns(const struct i2c_job *job)
+{
+	return job->start_ns + (job->end_ns - job->start_ns) / 2;
+}
+
+#if defined(CONFIG_APP_I2C_SCHED)
+
+/**
+ * @brief Set up a job and register it for the report, once per job.
+ */
+void i2c_job_init(struct i2c_job *job, const char *name, i2c_job_fn fn);
+
+/**
+ * @brief Run a job in the next batch and wait for it.
+ *
+ * Not callable from the scheduler thread or an ISR.
+ *
+ * Returns: result of the job function.
+ */
+int i2c_sched_run(struct i2c_job *job);
+
+/** Scheduler totals since boot */
+void i2c_sched_stats(struct i2c_sched_stats *out);
+
+/**
+ * @brief Accounting of the idx-th registered job.
+ *
+ * Returns: 0 on success, -ENOENT past the last job.
+ */
+int i2c_sched_job_stats(int idx, const char **name, struct i2c_job_stats *out);
+
+#else
+
+static inline void i2c_job_init(struct i2c_job *job, const char *name, i2c_job_fn fn)
+{
+	job->name = name;
+	job->fn = fn;
+}
+
+static inline int i2c_sched_run(struct i2c_job *job)
+{
+	job->start_ns = sensor_timestamp_ns();
+	job->result = job->fn(job);
+	job->end_ns = sensor_timestamp_ns();
+	return job->result;
+}
+
+#endif
+
+#endif /* I2C_SCHED_H */
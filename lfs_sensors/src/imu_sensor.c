@@ -19,9 +19,15 @@
 #include <zephyr/device.h>
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/i2c.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 #include <errno.h>
 
+#include "i2c_sched.h"
+#include "power.h"
+#include "sensor_bus.h"
+
 //==============================================================================
 // Device Tree Bindings
 //==============================================================================
@@ -29,6 +35,7 @@
 #if DT_NODE_EXISTS(DT_ALIAS(imu_sensor))
 #define IMU_NODE DT_ALIAS(imu_sensor)
 static const struct device *const imu_dev = DEVICE_DT_GET(IMU_NODE);
+static const struct device *const imu_bus = DEVICE_DT_GET(DT_BUS(IMU_NODE));
 #else
 #error("IMU sensor not found in device tree.")
 #endif
@@ -39,45 +46,171 @@ static const struct device *const imu_dev = DEVICE_DT_GET(IMU_NODE);
 
 LOG_MODULE_REGISTER(imu, CONFIG_APP_LOG_LEVEL);
 
-//==============================================================================
-// Sensor-data structure
-//==============================================================================
-
-typedef struct {
-    double x, y, z;
-} imu_data_t;
-
-typedef struct {
-        imu_data_t accel;
-        imu_data_t gyro;
-} imu_sensor_data;
-
 //==============================================================================
 // Configuration Constants
 //==============================================================================
 
-#define MAX_MSGS		10			// Maximum number of sensor samples in queue
-#define MSG_ALIGN		32			// Align message queue entries
-#define MSG_SIZE		sizeof(imu_sensor_data) // Size of message equals struct size
 #define IMU_SENSOR_PRIORITY	5			// Thread priority for sensor task
+#if defined(CONFIG_APP_IMU_STREAM)
+#define IMU_THREAD_STACK_SIZE	2048			// Stack size for sensor thread, full rate listeners run on it
+#else
 #define IMU_THREAD_STACK_SIZE	1024			// Stack size for sensor thread
+#endif
+
+/*
+ * In streaming mode every sample goes to imu_raw_chan and every
+ * IMU_PUBLISH_EVERY-th one to imu_chan
+ */
+#define IMU_PUBLISH_EVERY	MAX(1, CONFIG_APP_IMU_PUBLISH_MS * CONFIG_APP_IMU_ODR_HZ / MSEC_PER_SEC)
+#define IMU_DRDY_TIMEOUT	K_MSEC(100)		// Re-read if a data-ready edge was missed
+#define IMU_WAKE_MS		80			// Gyroscope turn-on from power-down
 
 //==============================================================================
-// Message Queue
+// Burst Read
 //==============================================================================
 
-// Queue for transferring Acelerometer/Gyroscope readings between threads
+/*
+ * With the I2C scheduler the LSM6DSL gyroscope and accelerometer outputs
+ * are read in a single 12 byte auto-increment burst, where the driver
+ * issues one transaction per sensor. The scale follows the full-scale
+ * ranges the driver programmed.
+ */
+#if defined(CONFIG_APP_I2C_SCHED) && DT_NODE_HAS_COMPAT(IMU_NODE, st_lsm6dsl) && \
+	DT_ON_BUS(IMU_NODE, i2c)
+#define IMU_BURST
+
+#define LSM6DSL_REG_CTRL1_XL	0x10			// CTRL1_XL, CTRL2_G
+#define LSM6DSL_REG_OUTX_L_G	0x22			// OUTX_L_G .. OUTZ_H_XL
+#define LSM6DSL_FS(ctrl)	(((ctrl) >> 2) & 0x3)	// FS_XL or FS_G
+#define LSM6DSL_FS_125		BIT(1)			// CTRL2_G
+
+static const struct i2c_dt_spec imu_i2c = I2C_DT_SPEC_GET(IMU_NODE);
 
-struct k_msgq imu_sensor_msgq;
-K_MSGQ_DEFINE(imu_sensor_msgq, MSG_SIZE, MAX_MSGS, MSG_ALIGN);
+/* Sensitivity by FS_XL (+-2, 16, 4, 8 g) and FS_G (245 to 2000 dps) */
+static const uint16_t lsm6dsl_accel_ug[] = { 61, 488, 122, 244 };
+static const uint16_t lsm6dsl_gyro_udps[] = { 8750, 17500, 35000, 70000 };
+
+static struct {
+	double accel;				// m/s^2 per LSB
+	double gyro;				// rad/s per LSB
+} imu_scale;
+
+static uint8_t imu_raw[12];
+#endif
+
+static struct i2c_job imu_job;
 
 //==============================================================================
 // Function Prototypes
 //==============================================================================
 
-int imu_sensor_process(imu_sensor_data *sensor_data);
+int imu_sensor_process(imu_sample *sample);
 void imu_thread(void *, void *, void *);
 
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+/**
+ * @brief Set the accelerometer and gyroscope output data rate.
+ *
+ * Input: hz Rate, 0 powers both down.
+ *
+ * Returns: 0 on success, negative error code from the driver otherwise.
+ */
+static int imu_set_odr(int hz)
+{
+	struct sensor_value odr_attr = { .val1 = hz };
+	int ret;
+
+	ret = sensor_attr_set(imu_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr);
+	if (ret < 0) {
+		return ret;
+	}
+	return sensor_attr_set(imu_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr);
+}
+
+#if defined(IMU_BURST)
+/**
+ * @brief Read the full-scale ranges set by the driver, once at start-up.
+ *
+ * Returns: 0 on success, negative error code otherwise.
+ */
+static int imu_scale_load(void)
+{
+	uint8_t ctrl[2];
+	uint32_t gyro_udps;
+	int ret;
+
+	ret = i2c_burst_read_dt(&imu_i2c, LSM6DSL_REG_CTRL1_XL, ctrl, sizeof(ctrl));
+	if (ret < 0) {
+		return ret;
+	}
+
+	gyro_udps = (ctrl[1] & LSM6DSL_FS_125) ? 4375 : lsm6dsl_gyro_udps[LSM6DSL_FS(ctrl[1])];
+	imu_scale.accel = lsm6dsl_accel_ug[LSM6DSL_FS(ctrl[0])] * (SENSOR_G / 1e12);
+	imu_scale.gyro = gyro_udps * (SENSOR_PI / 1e12 / 180.0);
+	return 0;
+}
+#endif
+
+/**
+ * @brief Bus transfer of a sample, run by the I2C scheduler.
+ */
+static int imu_read(struct i2c_job *job)
+{
+	ARG_UNUSED(job);
+#if defined(IMU_BURST)
+	return i2c_burst_read_dt(&imu_i2c, LSM6DSL_REG_OUTX_L_G, imu_raw, sizeof(imu_raw));
+#else
+	/* One fetch reads accelerometer and gyroscope */
+	return sensor_sample_fetch(imu_dev);
+#endif
+}
+
+//==============================================================================
+// Sample Pacing
+//==============================================================================
+
+#if defined(CONFIG_APP_IMU_STREAM)
+/*
+ * Given once per output sample, by the data-ready interrupt where the driver
+ * supports it and by a timer at the ODR otherwise
+ */
+static K_SEM_DEFINE(imu_ready_sem, 0, 1);
+
+static void imu_drdy_handler(const struct device *dev, const struct sensor_trigger *trig)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(trig);
+	k_sem_give(&imu_ready_sem);
+}
+
+static void imu_tick(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+	k_sem_give(&imu_ready_sem);
+}
+
+static K_TIMER_DEFINE(imu_timer, imu_tick, NULL);
+
+static void imu_pacing_start(void)
+{
+	static const struct sensor_trigger drdy = {
+		.type = SENSOR_TRIG_DATA_READY,
+		.chan = SENSOR_CHAN_ACCEL_XYZ,
+	};
+	k_timeout_t period = K_USEC(USEC_PER_SEC / CONFIG_APP_IMU_ODR_HZ);
+
+	if (sensor_trigger_set(imu_dev, &drdy, imu_drdy_handler) == 0) {
+		LOG_INF("IMU streaming at %d Hz on data-ready", CONFIG_APP_IMU_ODR_HZ);
+		return;
+	}
+	k_timer_start(&imu_timer, period, period);
+	LOG_INF("IMU streaming at %d Hz on a timer", CONFIG_APP_IMU_ODR_HZ);
+}
+#endif
+
 //==============================================================================
 // Function Definition
 //==============================================================================
@@ -85,34 +218,36 @@ void imu_thread(void *, void *, void *);
 /**
  * @brief Fetch and process IMU sensor readings (accelerometer + gyroscope).
  *
- * This function checks whether the IMU sensor device is ready,
- * fetches the latest sample, and extracts both acceleration and gyroscope
- * values across all three axes (X, Y, Z).
+ * This function fetches the latest sample through the I2C scheduler and
+ * extracts both acceleration and gyroscope values across all three axes
+ * (X, Y, Z). The sample is stamped with the middle of the bus transfer.
  *
- * Input:  data_struct Pointer to a imu_data_t struct where accelerometer and gyroscope data will be stored.
+ * Input:  sample Pointer to a imu_sample struct where accelerometer and gyroscope data will be stored.
  *
  * Returns: 0  Success, values stored in accel and gyro elements.
  * 	   -1  Failure, error logged.
  */
 
-int imu_sensor_process(imu_sensor_data *sensor_data)
+int imu_sensor_process(imu_sample *sample)
 {
+	imu_sensor_data *sensor_data = &sample->data;
 
-	if (sensor_sample_fetch(imu_dev) < 0) {
+	if (i2c_sched_run(&imu_job) < 0) {
 		LOG_ERR("sensor: %s sample update error", imu_dev->name);
 		return -1;
 	}
+	sample->ts_ns = i2c_job_ts_ns(&imu_job);
 
-	/* Fetch channel for accelerometer and gyrometer */
-	if (sensor_sample_fetch_chan(imu_dev, SENSOR_CHAN_ACCEL_XYZ) < 0) {
-		LOG_ERR("Sensor: %s fetch failed.", imu_dev->name);
-		return -1;
-	}
-	if (sensor_sample_fetch_chan(imu_dev, SENSOR_CHAN_GYRO_XYZ) < 0) {
-		LOG_ERR("Sensor: %s fetch failed.", imu_dev->name);
-		return -1;
-	}
-	
+#if defined(IMU_BURST)
+	/* Gyroscope X, Y, Z then accelerometer X, Y, Z */
+	sensor_data->gyro.x = (int16_t)sys_get_le16(&imu_raw[0]) * imu_scale.gyro;
+	sensor_data->gyro.y = (int16_t)sys_get_le16(&imu_raw[2]) * imu_scale.gyro;
+	sensor_data->gyro.z = (int16_t)sys_get_le16(&imu_raw[4]) * imu_scale.gyro;
+
+	sensor_data->accel.x = (int16_t)sys_get_le16(&imu_raw[6]) * imu_scale.accel;
+	sensor_data->accel.y = (int16_t)sys_get_le16(&imu_raw[8]) * imu_scale.accel;
+	sensor_data->accel.z = (int16_t)sys_get_le16(&imu_raw[10]) * imu_scale.accel;
+#else
 	struct sensor_value accel_x, accel_y, accel_z;
 	struct sensor_value gyro_x, gyro_y, gyro_z;
 
@@ -133,8 +268,9 @@ int imu_sensor_process(imu_sensor_data *sensor_data)
 	sensor_data->accel.z = sensor_value_to_double(&accel_z);
 
 	sensor_data->gyro.x = sensor_value_to_double(&gyro_x);
-	sensor_data->gyro.y = sensor_value_to_double(&gyro_x);
-	sensor_data->gyro.z = sensor_value_to_double(&gyro_x);
+	sensor_data->gyro.y = sensor_value_to_double(&gyro_y);
+	sensor_data->gyro.z = sensor_value_to_double(&gyro_z);
+#endif
 
 	return 0;
 }
@@ -160,43 +296,101 @@ K_THREAD_DEFINE(imu_tid, IMU_THREAD_STACK_SIZE, imu_thread, NULL, NULL, NULL, IM
  * Workflow:
  *  1. Ensure the IMU is ready.
  *  2. Configure sensor attributes (sampling frequency).
- *  3. Periodically fetch accel + gyro readings.
- *  4. Publish results to the message queue.
+ *  3. Periodically fetch accel + gyro readings, at the full ODR when a
+ *     consumer needs every sample (APP_IMU_STREAM).
+ *  4. Publish results to the sensor bus.
  */
 
 void imu_thread(void *, void *, void *)
 {
 	LOG_INF("IMU sensor thread started");
-	imu_sensor_data sensor_data;
+	imu_sample sample;
 
 	if (!device_is_ready(imu_dev)) {
                 LOG_ERR("sensor: device not ready.\n");
                 return;
         }
 
-        struct sensor_value odr_attr;
-        /* set accel/gyro sampling frequency to 104 Hz */
-        odr_attr.val1 = 104;
-        odr_attr.val2 = 0;
+        power_enable(POWER_DOM_BUS, imu_bus);
+        power_enable(POWER_DOM_IMU, imu_dev);
 
-        if (sensor_attr_set(imu_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr) < 0) {
-                LOG_ERR("Cannot set sampling frequency for accelerometer.\n");
+        /* set accel/gyro sampling frequency */
+        power_get(POWER_DOM_BUS, imu_bus);
+        power_get(POWER_DOM_IMU, imu_dev);
+        if (imu_set_odr(CONFIG_APP_IMU_ODR_HZ) < 0) {
+                LOG_ERR("Cannot set sampling frequency for accelerometer and gyro.\n");
+                power_put(POWER_DOM_IMU, imu_dev);
+                power_put(POWER_DOM_BUS, imu_bus);
                 return;
         }
-
-        if (sensor_attr_set(imu_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr_attr) < 0) {
-                LOG_ERR("Cannot set sampling frequency for gyro.\n");
+        i2c_job_init(&imu_job, "imu", imu_read);
+#if defined(IMU_BURST)
+        if (imu_scale_load() < 0) {
+                LOG_ERR("sensor: %s cannot read its full-scale ranges", imu_dev->name);
+                power_put(POWER_DOM_IMU, imu_dev);
+                power_put(POWER_DOM_BUS, imu_bus);
                 return;
         }
+#endif
         LOG_INF("IMU sensor Initialized.");
 
+#if defined(CONFIG_APP_IMU_STREAM)
+	uint32_t count = 0;
+
+	/* Streaming keeps the IMU and its bus resumed for good */
+	imu_pacing_start();
+
 	while(1) {
-		if(imu_sensor_process(&sensor_data) == 0) {
-			k_msgq_put(&imu_sensor_msgq, &sensor_data, K_MSEC(1000));
+		k_sem_take(&imu_ready_sem, IMU_DRDY_TIMEOUT);
+		if(imu_sensor_process(&sample) < 0) {
+			continue;
+		}
+		zbus_chan_pub(&imu_raw_chan, &sample, K_MSEC(10));
+		if(++count % IMU_PUBLISH_EVERY == 0) {
+			zbus_chan_pub(&imu_chan, &sample, K_MSEC(1000));
+		}
+	}
+#else
+	bool idle = IS_ENABLED(CONFIG_APP_POWER_SENSOR_IDLE);
+	int ret;
+
+	/* Snapshots only need the IMU powered for a moment */
+	if (idle && imu_set_odr(0) < 0) {
+		LOG_INF("sensor: %s cannot power down, stays at %d Hz", imu_dev->name,
+			CONFIG_APP_IMU_ODR_HZ);
+		idle = false;
+	}
+	power_put(POWER_DOM_IMU, imu_dev);
+	power_put(POWER_DOM_BUS, imu_bus);
+
+	while(1) {
+		/* Wake early enough for the read to land on the shared deadline */
+		uint32_t lead_ms = idle ? IMU_WAKE_MS : 0;
+		int64_t slot = sensor_next_slot_ms(CONFIG_APP_IMU_PUBLISH_MS, lead_ms);
+
+		k_sleep(K_TIMEOUT_ABS_MS(slot - lead_ms));
+		power_get(POWER_DOM_IMU, imu_dev);
+		if(idle) {
+			/* The bus is free while the IMU wakes up */
+			power_get(POWER_DOM_BUS, imu_bus);
+			imu_set_odr(CONFIG_APP_IMU_ODR_HZ);
+			power_put(POWER_DOM_BUS, imu_bus);
+			k_sleep(K_TIMEOUT_ABS_MS(slot));
+		}
+		power_get(POWER_DOM_BUS, imu_bus);
+		ret = imu_sensor_process(&sample);
+		if(idle) {
+			imu_set_odr(0);
+		}
+		power_put(POWER_DOM_BUS, imu_bus);
+		power_put(POWER_DOM_IMU, imu_dev);
+
+		if(ret == 0) {
+			zbus_chan_pub(&imu_chan, &sample, K_MSEC(1000));
 		}
 		LOG_DBG("Accel: {x:%.2f y:%.2f z:%.2f], Gyro: [x:%.2f y:%.2f z:%.2f]", 
-			sensor_data.accel.x, sensor_data.accel.y, sensor_data.accel.z, 
-			sensor_data.gyro.x, sensor_data.gyro.y, sensor_data.gyro.z);
-		k_sleep(K_MSEC(5000));
+			sample.data.accel.x, sample.data.accel.y, sample.data.accel.z, 
+			sample.data.gyro.x, sample.data.gyro.y, sample.data.gyro.z);
 	}
+#endif
 }
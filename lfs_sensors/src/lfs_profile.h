@@ -0,0 +1,33 @@
+/**
+ * @file lfs_profile.h
+ * @brief LittleFS geometry of the log partition.
+ *
+ * A zephyr,fstab,littlefs node labelled lfs1 in the board overlay takes
+ * precedence, otherwise the sizes come from the APP_LFS_PROFILE Kconfig
+ * choice made in the board .conf file.
+ */
+
+#ifndef LFS_PROFILE_H
+#define LFS_PROFILE_H
+
+#include <zephyr/devicetree.h>
+
+#define LFS_FSTAB_NODE			DT_NODELABEL(lfs1)
+
+#if DT_NODE_HAS_COMPAT(LFS_FSTAB_NODE, zephyr_fstab_littlefs)
+#define LFS_PROFILE_FROM_FSTAB		1
+#define LFS_PROFILE_READ_SIZE		DT_PROP(LFS_FSTAB_NODE, read_size)
+#define LFS_PROFILE_PROG_SIZE		DT_PROP(LFS_FSTAB_NODE, prog_size)
+#define LFS_PROFILE_CACHE_SIZE		DT_PROP(LFS_FSTAB_NODE, cache_size)
+#define LFS_PROFILE_LOOKAHEAD_SIZE	DT_PROP(LFS_FSTAB_NODE, lookahead_size)
+#define LFS_PROFILE_BLOCK_CYCLES	DT_PROP(LFS_FSTAB_NODE, block_cycles)
+#else
+#define LFS_PROFILE_FROM_FSTAB		0
+#define LFS_PROFILE_READ_SIZE		CONFIG_APP_LFS_READ_SIZE
+#define LFS_PROFILE_PROG_SIZE		CONFIG_APP_LFS_PROG_SIZE
+#define LFS_PROFILE_CACHE_SIZE		CONFIG_APP_LFS_CACHE_SIZE
+#define LFS_PROFILE_LOOKAHEAD_SIZE	CONFIG_APP_LFS_LOOKAHEAD_SIZE
+#define LFS_PROFILE_BLOCK_CYCLES	CONFIG_APP_LFS_BLOCK_CYCLES
+#endif
+
+#endif /* LFS_PROFILE_H */
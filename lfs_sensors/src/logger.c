@@ -14,15 +14,17 @@
 // Includes
 //==============================================================================
 
-#include <zephyr/kernel.h>
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
-#include <zephyr/fs/fs.h>
-#include <zephyr/fs/littlefs.h>
 #include <zephyr/logging/log.h>
-#include <zephyr/storage/flash_map.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
+
+#include "align.h"
+#include "log_store.h"
+#include "power.h"
+#include "sensor_bus.h"
 
 //==============================================================================
 // Logging Module Register
@@ -31,61 +33,74 @@
 LOG_MODULE_REGISTER(logger);
 
 //==============================================================================
-// Structure definitons of sensors
+// Configuration Constants
 //==============================================================================
 
 /*
- * Structures of HTS221, LPS22HB and LSM6DSL
+ * Constants for sensor data struct and thread
  */
+#define SENSORS_BUF_SIZE		sizeof(sensors_shared_buf)
+#define SENSORS_THREADS_PRIORITY	5
+#define LOGGER_THREAD_STACK_SIZE	(2*1024)
 
-typedef struct {
-        double humidity;
-        double temperature;
-} hum_temp_data;
-
-typedef struct {
-        double pressure;
-} press_data;
-
-typedef struct {
-    double x, y, z;
-} imu_data_t;
-
-typedef struct {
-        imu_data_t accel;
-        imu_data_t gyro;
-} imu_sensor_data;
+/*
+ * Constants for aggregation: a record is written every LOG_PERIOD_MS
+ */
+#define LOG_PERIOD_MS			60000
 
-typedef struct {
-        hum_temp_data hts_data;
-        press_data lps_data;
-        imu_sensor_data imu_data;
-} sensors_shared_buf;
+/* Minimum time from a record to an early one */
+#if defined(CONFIG_APP_ANOMALY)
+#define FLUSH_HOLDOFF_MS		CONFIG_APP_ANOMALY_FLUSH_HOLDOFF_MS
+#else
+#define FLUSH_HOLDOFF_MS		0
+#endif
 
-//==============================================================================
-// External Sensor Queues
-//==============================================================================
+#define DOUBLES(type)			(sizeof(type) / sizeof(double))
 
-extern struct k_msgq ht_sensor_msgq;
-extern struct k_msgq lp_sensor_msgq;
-extern struct k_msgq imu_sensor_msgq;
+BUILD_ASSERT(offsetof(hum_temp_sample, data) == sizeof(uint64_t) &&
+	     offsetof(press_sample, data) == sizeof(uint64_t) &&
+	     offsetof(imu_sample, data) == sizeof(uint64_t),
+	     "samples must be a timestamp followed by doubles");
+BUILD_ASSERT(DOUBLES(imu_sensor_data) <= ALIGN_MAX_VALUES);
 
 //==============================================================================
-// Configuration Constants
+// Aggregation State
 //==============================================================================
 
 /*
- * Constants for sensor data struct and thread
+ * One aligner per sensor channel, fed by the zbus listener in the
+ * publishing thread and read by the logger thread
  */
-#define SENSORS_BUF_SIZE		sizeof(sensors_shared_buf)
-#define SENSORS_THREADS_PRIORITY	5
-#define LOGGER_THREAD_STACK_SIZE	(2*1024)
+struct sensor_channel {
+	const struct zbus_channel *chan;
+	struct align_channel align;
+};
 
-/*
- * Constants for File
- */
-#define FILE_SIZE			1024		// Max file size in bytes
-#define MAX_FILES			10		// Maximum number of log files
+static struct sensor_channel channels[] = {
+	{ &ht_chan, { .nvals = DOUBLES(hum_temp_data) } },
+	{ &lp_chan, { .nvals = DOUBLES(press_data) } },
+	{ &imu_chan, { .nvals = DOUBLES(imu_sensor_data) } },
+};
+
+static struct k_spinlock align_lock;
+
+/* Flash device behind lfs1_partition, used by every storage backend */
+static const struct device *const log_flash =
+	DEVICE_DT_GET(DT_MTD_FROM_FIXED_PARTITION(DT_NODELABEL(lfs1_partition)));
+
+/* Given to write the next record now instead of at the end of the period */
+static K_SEM_DEFINE(flush_sem, 0, 1);
+
+#if defined(CONFIG_APP_ANOMALY)
+/* An anomaly was raised since the last record, guarded by align_lock */
+static bool anomaly_pending;
+#endif
+
+#if defined(CONFIG_APP_VIBRATION)
+/* Strongest vibration window since the last record, guarded by align_lock */
+static vib_features vib_worst;
+static bool vib_valid;
+#endif
 
 //==============================================================================
 // Function Prototypes
@@ -109,10 +124,19 @@ static void logger_thread(void *, void *, void *);
 static void print_sensor_data(size_t *fptr, sensors_shared_buf *sensor_buffer)
 {
 	// Prints sensor data on console
-	LOG_INF("|Sample%d |	Humidity: %.2f	|	Temperature: %.2f |	Pressure: %.2f	|	Accel: [x:%.2f, y:%.2f, z:%.2f]	|	Gyro: [x:%.2f, y:%.2f, z:%.2f] |", 
-			*fptr, sensor_buffer->hts_data.humidity, sensor_buffer->hts_data.temperature, sensor_buffer->lps_data.pressure,
+	LOG_INF("|Sample%d | t: %llu ms (+-%u us%s%s) |	Humidity: %.2f	|	Temperature: %.2f |	Pressure: %.2f	|	Accel: [x:%.2f, y:%.2f, z:%.2f]	|	Gyro: [x:%.2f, y:%.2f, z:%.2f] |", 
+			*fptr, sensor_buffer->timestamp_ns / NSEC_PER_MSEC, sensor_buffer->align_err_us,
+			(sensor_buffer->flags & SENSOR_REC_F_UNBRACKETED) ? ", nearest" : "",
+			(sensor_buffer->flags & SENSOR_REC_F_ANOMALY) ? ", ANOMALY" : "",
+			sensor_buffer->hts_data.humidity, sensor_buffer->hts_data.temperature, sensor_buffer->lps_data.pressure,
 			sensor_buffer->imu_data.accel.x, sensor_buffer->imu_data.accel.y, sensor_buffer->imu_data.accel.z, 
 			sensor_buffer->imu_data.gyro.x, sensor_buffer->imu_data.gyro.y, sensor_buffer->imu_data.gyro.z);
+	if (sensor_buffer->flags & SENSOR_REC_F_VIB) {
+		LOG_INF("|Sample%d | Vibration: rms %.3f | peak %.1f Hz | bands [%.3f, %.3f, %.3f, %.3f] |",
+			*fptr, (double)sensor_buffer->vib.rms, (double)sensor_buffer->vib.peak_hz,
+			(double)sensor_buffer->vib.band_rms[0], (double)sensor_buffer->vib.band_rms[1],
+			(double)sensor_buffer->vib.band_rms[2], (double)sensor_buffer->vib.band_rms[3]);
+	}
 }
 
 //==============================================================================
@@ -120,192 +144,236 @@ static void print_sensor_data(size_t *fptr, sensors_shared_buf *sensor_buffer)
 //==============================================================================
 
 /**
- * @brief Append sensor data to a log file.
+ * @brief zbus listener, runs in the publishing sensor thread.
  *
- * Opens a LittleFS file, appends new sensor data, and if the file size exceeds
- * a limit, rotates to a new file. Afterwards, it re-reads the file contents
- * and prints them for verification.
+ * Reads the sample in place from the channel and keeps it in the aligner.
  *
- * Input: shared_buf Pointer to the data structure containing all sensor data.
+ * Input: chan Channel that was published.
  */
-
-
-static void logger_func(sensors_shared_buf *shared_buf)
+static void logger_listener_cb(const struct zbus_channel *chan)
 {
-	struct fs_file_t file;
-	fs_file_t_init(&file);
-
-	char filename[32];
-	uint8_t file_num = 1;
-	snprintf(filename, sizeof(filename), "/lfs/sensor%d.log", file_num);
-	
-	int ret = fs_open(&file, filename, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
-	if (ret < 0) {
-		LOG_ERR("Failed to open file /lfs/sensor%d.log: %d", file_num,ret);
-		return;
-	}
+	// Every sample is a timestamp followed by doubles
+	const uint64_t *msg = zbus_chan_const_msg(chan);
 
-	struct fs_dirent file_entry;
-	fs_stat(filename, &file_entry);
-	if (file_entry.size >= FILE_SIZE) {
-		fs_close(&file);
-		
-		file_num++;
-		
-		snprintf(filename, sizeof(filename), "/lfs/sensor%d.log", file_num);
-		fs_file_t_init(&file);
-
-		ret = fs_open(&file, filename, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
-		if (ret < 0) {
-			LOG_ERR("Failed to open file /lfs/sensor%d.log: %d", file_num,ret);
+	for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+		if (channels[i].chan == chan) {
+			k_spinlock_key_t key = k_spin_lock(&align_lock);
+
+			align_push(&channels[i].align, msg[0], (const double *)&msg[1]);
+			k_spin_unlock(&align_lock, key);
 			return;
 		}
-		ret = fs_write(&file, shared_buf, sizeof(sensors_shared_buf));
-		file_num++;
-	} else {
-		ret = fs_write(&file, shared_buf, sizeof(sensors_shared_buf));
-                if (ret != sizeof(sensors_shared_buf)) {
-                        LOG_ERR("Failed to write file /lfs/sensors.log: %d", ret);
-                        // need to close file and return
-
-                        fs_close(&file);
-                        return;
-                }
 	}
+}
 
-	off_t current_fp = fs_tell(&file);
-	current_fp = fs_tell(&file);
-	fs_seek(&file, 0, FS_SEEK_SET);
-	sensors_shared_buf temp_buf = {0};
+ZBUS_LISTENER_DEFINE(logger_lis, logger_listener_cb);
+ZBUS_CHAN_ADD_OBS(ht_chan, logger_lis, 0);
+ZBUS_CHAN_ADD_OBS(lp_chan, logger_lis, 0);
+ZBUS_CHAN_ADD_OBS(imu_chan, logger_lis, 0);
 
-	for (size_t fptr = 0; fptr < (current_fp / sizeof(sensors_shared_buf)); fptr++ ) {
-		if ( fs_read(&file, &temp_buf, sizeof(sensors_shared_buf)) != sizeof(sensors_shared_buf)) {
-			LOG_ERR("Incorrect read");
-			fs_close(&file);
+#if defined(CONFIG_APP_VIBRATION)
+/**
+ * @brief zbus listener on vib_chan, keeps the strongest window of the period.
+ *
+ * Input: chan vib_chan.
+ */
+static void logger_vib_cb(const struct zbus_channel *chan)
+{
+	const vib_sample *v = zbus_chan_const_msg(chan);
+	k_spinlock_key_t key = k_spin_lock(&align_lock);
 
-			return;
-		}
-		// print sensor data
-		print_sensor_data(&fptr, &temp_buf);
+	if (!vib_valid || v->features.rms > vib_worst.rms) {
+		vib_worst = v->features;
+		vib_valid = true;
 	}
-	fs_close(&file);
+	k_spin_unlock(&align_lock, key);
 }
 
-//==============================================================================
-// Thread Definition
-//==============================================================================
+ZBUS_LISTENER_DEFINE(logger_vib_lis, logger_vib_cb);
+ZBUS_CHAN_ADD_OBS(vib_chan, logger_vib_lis, 0);
+#endif
 
-/*
- * Definition of Logger thread
+#if defined(CONFIG_APP_ANOMALY)
+/**
+ * @brief zbus listener on anomaly_chan, tags the next record and writes it now.
+ *
+ * Input: chan anomaly_chan.
  */
+static void logger_anomaly_cb(const struct zbus_channel *chan)
+{
+	k_spinlock_key_t key = k_spin_lock(&align_lock);
 
-K_THREAD_DEFINE(logger_tid, LOGGER_THREAD_STACK_SIZE, logger_thread, 
-		NULL, NULL, NULL, 
-		SENSORS_THREADS_PRIORITY, 0, 1000);
+	ARG_UNUSED(chan);
+	anomaly_pending = true;
+	k_spin_unlock(&align_lock, key);
+	k_sem_give(&flush_sem);
+}
 
-//==============================================================================
-// Thread Function
-//==============================================================================
+ZBUS_LISTENER_DEFINE(logger_anomaly_lis, logger_anomaly_cb);
+ZBUS_CHAN_ADD_OBS(anomaly_chan, logger_anomaly_lis, 0);
+#endif
 
 /**
- * @brief Logger thread.
+ * @brief Build a record with every channel resampled at one instant.
+ *
+ * The instant is the newest one all channels have reached, so the slowest
+ * channel is used as sampled and the others are interpolated around it.
  *
- * Collects data from all sensor queues, aggregates into a single buffer,
- * and writes it into LittleFS periodically.
+ * Input: shared_buf Record to fill.
+ *
+ * Returns: 0  Success
+ *	   <0  A channel has not produced a sample yet
  */
-
-void logger_thread(void *, void *, void *)
+static int aggregate(sensors_shared_buf *shared_buf)
 {
-	sensors_shared_buf shared_buf;
-	LOG_INF("Logger Thread started");
-	while (1) {
-		k_msgq_get(&ht_sensor_msgq, &shared_buf.hts_data, K_SECONDS(10));
-		k_msgq_get(&lp_sensor_msgq, &shared_buf.lps_data, K_SECONDS(10));
-		k_msgq_get(&imu_sensor_msgq, &shared_buf.imu_data, K_SECONDS(10));
-			
-		logger_func(&shared_buf);
-		k_sleep(K_SECONDS(60));
+	struct align_channel *aligners[ARRAY_SIZE(channels)];
+	double *dest[ARRAY_SIZE(channels)] = {
+		(double *)&shared_buf->hts_data,
+		(double *)&shared_buf->lps_data,
+		(double *)&shared_buf->imu_data,
+	};
+	uint64_t t_ns, err_ns, max_err_ns = 0;
+	k_spinlock_key_t key;
+	int ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+		aligners[i] = &channels[i].align;
 	}
-}
 
-//==============================================================================
-// LittleFS Mount & Flash Management
-//==============================================================================
+	key = k_spin_lock(&align_lock);
+	ret = align_common_time(aligners, ARRAY_SIZE(aligners), &t_ns);
+	if (ret < 0) {
+		k_spin_unlock(&align_lock, key);
+		return ret;
+	}
 
-/* Default LittleFS Configuration */
-FS_LITTLEFS_DECLARE_DEFAULT_CONFIG(lfs1);
+	shared_buf->timestamp_ns = t_ns;
+	shared_buf->flags = 0;
+	for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+		if (!align_at(aligners[i], t_ns, dest[i], &err_ns)) {
+			shared_buf->flags |= SENSOR_REC_F_UNBRACKETED;
+		}
+		max_err_ns = MAX(max_err_ns, err_ns);
+	}
 
-/* LittleFS mount point */
-static struct fs_mount_t lfs_mount_pt = {
-	.type = FS_LITTLEFS,
-	.fs_data = &lfs1,
-	.storage_dev = (void *)FIXED_PARTITION_ID(lfs1_partition),
-	.mnt_point = "/lfs",
-};
+	memset(&shared_buf->vib, 0, sizeof(shared_buf->vib));
+#if defined(CONFIG_APP_VIBRATION)
+	if (vib_valid) {
+		shared_buf->vib = vib_worst;
+		shared_buf->flags |= SENSOR_REC_F_VIB;
+		vib_valid = false;
+	}
+#endif
+#if defined(CONFIG_APP_ANOMALY)
+	if (anomaly_pending) {
+		shared_buf->flags |= SENSOR_REC_F_ANOMALY;
+		anomaly_pending = false;
+	}
+#endif
+	k_spin_unlock(&align_lock, key);
+
+	shared_buf->align_err_us = MIN(max_err_ns / NSEC_PER_USEC, UINT32_MAX);
+	return 0;
+}
 
 /**
- * @brief Erase flash area used by LittleFS.
+ * @brief Print one record read back from storage.
  *
- * Input: id Partition ID of the flash area to erase.
+ * Input: rec		Record in storage, possibly memory-mapped flash.
+ *	  len		Record length.
+ *	  user_data	Running sample index.
  *
- * Returns: 0  Success
- * 	   <0  Error code
+ * Returns: 0 to keep walking.
  */
-
-static int littlefs_flash_erase(unsigned int id)
+static int print_stored_record(const void *rec, size_t len, void *user_data)
 {
-        const struct flash_area *pfa;
-        int rc;
+	size_t *fptr = user_data;
+	sensors_shared_buf temp_buf;
+
+	// Records in flash need not be aligned for double access
+	memcpy(&temp_buf, rec, sizeof(temp_buf));
+	print_sensor_data(fptr, &temp_buf);
+	(*fptr)++;
+	return 0;
+}
+
+/**
+ * @brief Append sensor data to the log.
+ *
+ * Hands the record to the storage backend, which rotates to a new segment
+ * when the current one is full. Afterwards, it re-reads the records of the
+ * current segment and prints them for verification.
+ *
+ * Input: shared_buf Pointer to the data structure containing all sensor data.
+ */
 
-        rc = flash_area_open(id, &pfa);
-        if (rc < 0) {
-                LOG_ERR("FAIL: unable to find flash area %u: %d\n",id, rc);
-                return rc;
-        }
+static void logger_func(sensors_shared_buf *shared_buf)
+{
+	size_t fptr = 0;
+	int ret;
 
-        LOG_INF("Area %u at 0x%x on %s for %u bytes\n", id, (unsigned int)pfa->fa_off, pfa->fa_dev->name,(unsigned int)pfa->fa_size);
+	// One flash wake-up covers the append and the read-back
+	power_get(POWER_DOM_FLASH, log_flash);
 
-        /* Optional wipe flash contents */
-        rc = flash_area_flatten(pfa, 0, pfa->fa_size);
-        LOG_INF("Erasing flash area ... %d", rc);
+	ret = log_store.append(shared_buf);
+	if (ret < 0) {
+		LOG_ERR("Failed to append to %s log: %d", log_store.name, ret);
+	} else {
+		ret = log_store.walk_active(print_stored_record, &fptr);
+		if (ret < 0) {
+			LOG_ERR("Incorrect read: %d", ret);
+		}
+	}
 
-        flash_area_close(pfa);
-        return rc;
+	power_put(POWER_DOM_FLASH, log_flash);
 }
 
+//==============================================================================
+// Thread Definition
+//==============================================================================
+
+/*
+ * Definition of Logger thread
+ */
+
+K_THREAD_DEFINE(logger_tid, LOGGER_THREAD_STACK_SIZE, logger_thread, 
+		NULL, NULL, NULL, 
+		SENSORS_THREADS_PRIORITY, 0, 1000);
+
+//==============================================================================
+// Thread Function
+//==============================================================================
+
 /**
- * @brief Mount LittleFS at given mount point.
- *
- * Attempts to mount; if it fails, erases flash and retries.
- *
- * Input: mp Mount point structure.
+ * @brief Logger thread.
  *
- * Returns:  0  Success
- *	    <0  Error code
+ * Periodically aggregates the latest samples of all sensor channels at a
+ * common instant into a single buffer and writes it to the log storage.
+ * An anomaly event cuts the period short, at most once per
+ * APP_ANOMALY_FLUSH_HOLDOFF_MS.
  */
 
-static int littlefs_mount(struct fs_mount_t *mp)
+void logger_thread(void *, void *, void *)
 {
-        int rc;
-
-        /* Do not mount if auto-mount has been enabled */
-        rc = fs_mount(mp);
-        if (rc < 0) {
-		rc = littlefs_flash_erase((uintptr_t)mp->storage_dev);
-		if (rc < 0) {
-			LOG_ERR("Flash erase failed.");
-			return rc;
+	sensors_shared_buf shared_buf;
+	int64_t written_ms;
+
+	LOG_INF("Logger Thread started");
+	while (1) {
+		if (aggregate(&shared_buf) < 0) {
+			// Not every sensor has published yet
+			k_sleep(K_SECONDS(1));
+			continue;
 		}
-		rc = fs_mount(mp);
-                if (rc < 0) {
-			LOG_ERR("FAIL: mount id %" PRIuPTR " at %s: %d\n",(uintptr_t)mp->storage_dev, mp->mnt_point, rc);
-			return rc;
+		logger_func(&shared_buf);
+		written_ms = k_uptime_get();
+		if (k_sem_take(&flush_sem, K_MSEC(LOG_PERIOD_MS)) == 0) {
+			/* Events raised meanwhile tag the same early record */
+			k_sleep(K_TIMEOUT_ABS_MS(written_ms + FLUSH_HOLDOFF_MS));
+			k_sem_reset(&flush_sem);
+			LOG_INF("Early flush");
 		}
-		LOG_INF("%s is mounted: %d\n", mp->mnt_point, rc);
-        } else {
-		LOG_INF("%s is mounted: %d\n", mp->mnt_point, rc);
 	}
-	return 0;
 }
 
 //==============================================================================
@@ -315,7 +383,7 @@ static int littlefs_mount(struct fs_mount_t *mp)
 /**
  * @brief Initialize logger module.
  *
- * Mounts LittleFS filesystem before starting logging operations.
+ * Prepares the storage backend before starting logging operations.
  *
  * Returns: 0  Success
  * 	   <0  Error code
@@ -324,12 +392,16 @@ static int littlefs_mount(struct fs_mount_t *mp)
 int logger_init(void)
 {
 	int rc;
-	    rc = littlefs_mount(&lfs_mount_pt);
-	    if (rc < 0) {
-		    LOG_ERR("FAIL: mount id %" PRIuPTR " at %s: %d",(uintptr_t)lfs_mount_pt.storage_dev, lfs_mount_pt.mnt_point, rc);
-		    return rc;
-	    }
-	    LOG_INF("%s is mounted: %d", lfs_mount_pt.mnt_point, rc);
-
-	    return 0;
+
+	power_enable(POWER_DOM_FLASH, log_flash);
+	power_get(POWER_DOM_FLASH, log_flash);
+	rc = log_store.init(sizeof(sensors_shared_buf));
+	power_put(POWER_DOM_FLASH, log_flash);
+	if (rc < 0) {
+		LOG_ERR("FAIL: %s storage init: %d", log_store.name, rc);
+		return rc;
+	}
+	LOG_INF("Logging to %s storage", log_store.name);
+
+	return 0;
 }
@@ -23,6 +23,10 @@
 #include <zephyr/logging/log.h>
 #include <errno.h>
 
+#include "i2c_sched.h"
+#include "power.h"
+#include "sensor_bus.h"
+
 //==============================================================================
 // Device Tree Bindings
 //==============================================================================
@@ -30,6 +34,7 @@
 #if DT_NODE_EXISTS(DT_ALIAS(pressure_sensor))
 #define PRESSURE_NODE DT_ALIAS(pressure_sensor)
 static const struct device *const pressure_dev = DEVICE_DT_GET(PRESSURE_NODE);
+static const struct device *const pressure_bus = DEVICE_DT_GET(DT_BUS(PRESSURE_NODE));
 #else
 #error("Pressure sensor not found.");
 #endif
@@ -44,56 +49,58 @@ LOG_MODULE_REGISTER(pressure, CONFIG_APP_LOG_LEVEL);
 // Configuration Constants
 //==============================================================================
 
-#define MAX_MSGS			10 	// Maximum number of sensor samples in queue
-#define MSGQ_ALIGN      		32 	// Align message queue entries
 #define PRESSURE_SENSOR_PRIORITY	5 	// Thread priority for sensor task
-#define PRESSURE_THREAD_STACK_SIZE	512 	// Stack size for sensor thread
-
-//==============================================================================
-// Sensor-data structure
-//==============================================================================
-
-typedef struct {
-        double pressure;
-} press_data;
+#define PRESSURE_THREAD_STACK_SIZE	1024 	// Stack size for sensor thread, zbus listeners run on it
+#define PRESSURE_PERIOD_MS		5000	// Sampling period
 
-//==============================================================================
-// Message Queue
-//==============================================================================
-
-// Queue for transferring pressure readings between threads
-struct k_msgq lp_sensor_msgq;
-K_MSGQ_DEFINE(lp_sensor_msgq, sizeof(press_data), MAX_MSGS, MSGQ_ALIGN);
+/*
+ * The LPS22HB driver already reads its output registers in a single
+ * auto-increment burst, the job runs the driver fetch as it is
+ */
+static struct i2c_job pressure_job;
 
 //==============================================================================
 // Function Prototypes
 //==============================================================================
 
-int pressure_sensor_process(press_data *data_struct);
+int pressure_sensor_process(press_sample *sample);
 void pressure_thread(void *, void *, void *);
 
 //==============================================================================
 // Function Definitions
 //==============================================================================
 
+/**
+ * @brief Bus transfer of a sample, run by the I2C scheduler.
+ */
+static int pressure_read(struct i2c_job *job)
+{
+	ARG_UNUSED(job);
+	return sensor_sample_fetch(pressure_dev);
+}
+
 /**
  * @brief Fetch and process the pressure sensor reading.
  *
- * This function checks whether the pressure sensor device is ready,
- * fetches the latest sample, and extracts the pressure value in kPa.
+ * This function fetches the latest sample through the I2C scheduler,
+ * stamps it with the middle of the bus transfer and extracts the
+ * pressure value in kPa.
  *
- * Input: data_struct Pointer to store the fetched pressure.
+ * Input: sample Pointer to store the fetched pressure.
  *
  * Return: 0  Success, value stored in data_struct pressure element.
  * 	  -1  Failure, error logged.
  */
 
-int pressure_sensor_process(press_data *data_struct)
+int pressure_sensor_process(press_sample *sample)
 {
-	if (sensor_sample_fetch(pressure_dev) < 0) {
+	press_data *data_struct = &sample->data;
+
+	if (i2c_sched_run(&pressure_job) < 0) {
 		LOG_INF("sensor: %s sample update error", pressure_dev->name);
 		return -1;
 	}
+	sample->ts_ns = i2c_job_ts_ns(&pressure_job);
 
 	struct sensor_value pressure;
 	if (sensor_channel_get(pressure_dev, SENSOR_CHAN_PRESS, &pressure) < 0) {
@@ -128,8 +135,8 @@ K_THREAD_DEFINE(pressure_tid, PRESSURE_THREAD_STACK_SIZE, pressure_thread,
  * Workflow:
  *  1. Ensure the pressure sensor is ready.
  *  2. Periodically fetch a sample and process it.
- *  3. Push the result to the message queue.
- *  4. Sleep before the next iteration.
+ *  3. Publish the result on the sensor bus.
+ *  4. Sleep until the next deadline shared with the other sensors.
  */
 
 void pressure_thread(void *, void *, void *)
@@ -139,16 +146,35 @@ void pressure_thread(void *, void *, void *)
                 return;
         }
 
-        press_data data_struct;
+        press_sample sample;
+        int ret;
         LOG_INF("LP Thread started");
 
+        power_enable(POWER_DOM_BUS, pressure_bus);
+        power_enable(POWER_DOM_LP, pressure_dev);
+#if defined(CONFIG_APP_POWER_SENSOR_IDLE)
+        /* The driver has no one-shot conversion, run it at its slowest rate */
+        struct sensor_value odr = { .val1 = 1 };
+
+        if (sensor_attr_set(pressure_dev, SENSOR_CHAN_PRESS, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr) < 0) {
+                LOG_INF("sensor: %s keeps its default rate", pressure_dev->name);
+        }
+#endif
+        i2c_job_init(&pressure_job, "lps22hb", pressure_read);
+
         while (1)
         {
-                if (pressure_sensor_process(&data_struct) == 0){
-                        k_msgq_put(&lp_sensor_msgq, &data_struct, K_MSEC(1000));
+                power_get(POWER_DOM_BUS, pressure_bus);
+                power_get(POWER_DOM_LP, pressure_dev);
+                ret = pressure_sensor_process(&sample);
+                power_put(POWER_DOM_LP, pressure_dev);
+                power_put(POWER_DOM_BUS, pressure_bus);
+
+                if (ret == 0){
+                        zbus_chan_pub(&lp_chan, &sample, K_MSEC(1000));
                 }
-                LOG_DBG("Pressure: %.2f", data_struct.pressure);
-                k_sleep(K_MSEC(5000));
+                LOG_DBG("Pressure: %.2f", sample.data.pressure);
+                k_sleep(K_TIMEOUT_ABS_MS(sensor_next_slot_ms(PRESSURE_PERIOD_MS, 0)));
         }
 
 }
@@ -18,6 +18,18 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#if defined(CONFIG_APP_EXPORT)
+#include "log_export.h"
+#endif
+
+#if defined(CONFIG_APP_LFS_BENCH)
+#include "lfs_bench.h"
+#endif
+
+#if defined(CONFIG_APP_POWER)
+#include "power.h"
+#endif
+
 //==============================================================================
 // Logging Module Register
 //==============================================================================
@@ -43,9 +55,23 @@ int main(void)
 	k_msleep(5000);
 	LOG_INF("Welcome to zephyr\n");
 
+#if defined(CONFIG_APP_LFS_BENCH)
+	lfs_bench_run();
+#endif
+
+#if defined(CONFIG_APP_POWER)
+	power_init();
+#endif
+
 	if (logger_init() != 0) {
 		LOG_ERR("Logger init failed");
 		return -1;
 	}
+
+#if defined(CONFIG_APP_EXPORT)
+	if (log_export_init() != 0) {
+		LOG_ERR("Log export init failed");
+	}
+#endif
 	return 0;
 }
@@ -0,0 +1,158 @@
+/**
+ * @file power.c
+ * @brief Runtime device power management and duty-cycle report.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device_runtime.h>
+#include <errno.h>
+
+#include "power.h"
+#include "sensor_data.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(power, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Domain State
+//==============================================================================
+
+struct power_dom_state {
+	const char *name;
+	uint16_t users;			// Nested power_get() calls
+	uint64_t since_ns;		// Start of the current in-use span
+	struct power_dom_stats stats;
+};
+
+static struct power_dom_state doms[POWER_DOM_COUNT] = {
+	[POWER_DOM_BUS] = { "i2c" },
+	[POWER_DOM_HT] = { "hts221" },
+	[POWER_DOM_LP] = { "lps22hb" },
+	[POWER_DOM_IMU] = { "imu" },
+	[POWER_DOM_FLASH] = { "flash" },
+};
+
+static struct k_spinlock doms_lock;
+
+//==============================================================================
+// Function Definitions
+//==============================================================================
+
+int power_enable(enum power_dom dom, const struct device *dev)
+{
+	int ret = pm_device_runtime_enable(dev);
+
+	if (ret == -ENOTSUP || ret == -ENOSYS) {
+		LOG_INF("%s: no runtime PM in %s, stays powered", doms[dom].name, dev->name);
+		return -ENOTSUP;
+	}
+	if (ret < 0) {
+		LOG_ERR("%s: runtime PM enable failed: %d", doms[dom].name, ret);
+	}
+	return ret;
+}
+
+int power_get(enum power_dom dom, const struct device *dev)
+{
+	k_spinlock_key_t key;
+	int ret;
+
+	ret = pm_device_runtime_get(dev);
+	if (ret < 0) {
+		LOG_ERR("%s: resume failed: %d", doms[dom].name, ret);
+		return ret;
+	}
+
+	key = k_spin_lock(&doms_lock);
+	if (doms[dom].users++ == 0) {
+		doms[dom].since_ns = sensor_timestamp_ns();
+		doms[dom].stats.wakeups++;
+	}
+	k_spin_unlock(&doms_lock, key);
+	return 0;
+}
+
+void power_put(enum power_dom dom, const struct device *dev)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&doms_lock);
+	if (doms[dom].users > 0 && --doms[dom].users == 0) {
+		doms[dom].stats.active_ns += sensor_timestamp_ns() - doms[dom].since_ns;
+	}
+	k_spin_unlock(&doms_lock, key);
+
+	(void)pm_device_runtime_put(dev);
+}
+
+void power_stats(enum power_dom dom, struct power_dom_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&doms_lock);
+
+	*out = doms[dom].stats;
+	if (doms[dom].users > 0) {
+		out->active_ns += sensor_timestamp_ns() - doms[dom].since_ns;
+	}
+	k_spin_unlock(&doms_lock, key);
+}
+
+const char *power_dom_name(enum power_dom dom)
+{
+	return dom < POWER_DOM_COUNT ? doms[dom].name : "?";
+}
+
+int power_cpu_idle_permille(void)
+{
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+	k_thread_runtime_stats_t rt;
+
+	if (k_thread_runtime_stats_all_get(&rt) < 0 || rt.execution_cycles == 0) {
+		return -EAGAIN;
+	}
+	return (int)(rt.idle_cycles * 1000 / rt.execution_cycles);
+#else
+	return -ENOTSUP;
+#endif
+}
+
+//==============================================================================
+// Duty-Cycle Report
+//==============================================================================
+
+static void power_report(struct k_work *work)
+{
+	uint64_t now_ns = sensor_timestamp_ns();
+	struct power_dom_stats st;
+	int idle = power_cpu_idle_permille();
+
+	LOG_INF("Duty cycle after %llu s:", now_ns / NSEC_PER_SEC);
+	for (int d = 0; d < POWER_DOM_COUNT; d++) {
+		uint32_t ppm;
+
+		power_stats(d, &st);
+		ppm = st.active_ns / MAX(now_ns / 1000000, 1);
+		LOG_INF("  %-8s %3u.%03u %% on, %u wakeups, %llu us per wakeup",
+			power_dom_name(d), ppm / 10000, ppm % 10000 / 10, st.wakeups,
+			st.wakeups ? st.active_ns / NSEC_PER_USEC / st.wakeups : 0);
+	}
+	if (idle >= 0) {
+		LOG_INF("  cpu      %3d.%d %% idle", idle / 10, idle % 10);
+	}
+
+	k_work_schedule(k_work_delayable_from_work(work), K_SECONDS(CONFIG_APP_POWER_REPORT_S));
+}
+
+static K_WORK_DELAYABLE_DEFINE(report_work, power_report);
+
+void power_init(void)
+{
+	k_work_schedule(&report_work, K_SECONDS(CONFIG_APP_POWER_REPORT_S));
+}
@@ -0,0 +1,91 @@
+/**
+ * @file power.h
+ * @brief Runtime device power management and duty-cycle accounting.
+ *
+ * Every transaction on a sensor, its bus or the log flash is bracketed by
+ * power_get()/power_put(). They resume and suspend the device through
+ * PM_DEVICE_RUNTIME and account the time each power domain is in use, for
+ * the duty-cycle report. Without APP_POWER they compile to nothing.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <zephyr/device.h>
+#include <stdint.h>
+
+enum power_dom {
+	POWER_DOM_BUS,			// Sensor I2C bus
+	POWER_DOM_HT,
+	POWER_DOM_LP,
+	POWER_DOM_IMU,
+	POWER_DOM_FLASH,		// Log partition flash device
+	POWER_DOM_COUNT,
+};
+
+struct power_dom_stats {
+	uint32_t wakeups;		// Idle to in-use transitions
+	uint64_t active_ns;		// Time in use since boot
+};
+
+#if defined(CONFIG_APP_POWER)
+
+/**
+ * @brief Start the periodic duty-cycle report (APP_POWER_REPORT_S).
+ */
+void power_init(void);
+
+/**
+ * @brief Enable runtime PM of a device, once at start-up.
+ *
+ * The device is suspended until the first power_get().
+ *
+ * Returns: 0 on success, -ENOTSUP if the driver has no PM support and
+ *	    stays powered (accounting still works).
+ */
+int power_enable(enum power_dom dom, const struct device *dev);
+
+/**
+ * @brief Resume a device for a transaction.
+ *
+ * Returns: 0 on success, negative error code from PM otherwise.
+ */
+int power_get(enum power_dom dom, const struct device *dev);
+
+/**
+ * @brief Release a device after a transaction, suspending it when unused.
+ */
+void power_put(enum power_dom dom, const struct device *dev);
+
+/** Accounting of one domain since boot */
+void power_stats(enum power_dom dom, struct power_dom_stats *out);
+
+/** Domain name */
+const char *power_dom_name(enum power_dom dom);
+
+/**
+ * @brief CPU time spent in the idle thread since boot, in 1/1000.
+ *
+ * Returns: -ENOTSUP without CONFIG_SCHED_THREAD_USAGE_ALL.
+ */
+int power_cpu_idle_permille(void);
+
+#else
+
+static inline int power_enable(enum power_dom dom, const struct device *dev)
+{
+	return 0;
+}
+
+static inline int power_get(enum power_dom dom, const struct device *dev)
+{
+	return 0;
+}
+
+static inline void power_put(enum power_dom dom, const struct device *dev)
+{
+}
+
+#endif
+
+#endif /* POWER_H */
@@ -0,0 +1,40 @@
+/**
+ * @file sensor_bus.c
+ * @brief Definition of the sensor data channels.
+ *
+ * Channels are defined without observers, consumers add themselves.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "sensor_bus.h"
+
+//==============================================================================
+// Channel Definitions
+//==============================================================================
+
+ZBUS_CHAN_DEFINE(ht_chan, hum_temp_sample, NULL, NULL, ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+ZBUS_CHAN_DEFINE(lp_chan, press_sample, NULL, NULL, ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+ZBUS_CHAN_DEFINE(imu_chan, imu_sample, NULL, NULL, ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+
+#if defined(CONFIG_APP_IMU_STREAM)
+ZBUS_CHAN_DEFINE(imu_raw_chan, imu_sample, NULL, NULL, ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+#endif
+
+#if defined(CONFIG_APP_IMU_FUSION)
+ZBUS_CHAN_DEFINE(orient_chan, orient_sample, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+		 ZBUS_MSG_INIT(0, { 1.0f, 0.0f, 0.0f, 0.0f }));
+#endif
+
+#if defined(CONFIG_APP_VIBRATION)
+ZBUS_CHAN_DEFINE(vib_chan, vib_sample, NULL, NULL, ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+#endif
+
+#if defined(CONFIG_APP_ANOMALY)
+ZBUS_CHAN_DEFINE(anomaly_chan, anomaly_event, NULL, NULL, ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+#endif
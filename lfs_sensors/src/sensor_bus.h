@@ -0,0 +1,43 @@
+/**
+ * @file sensor_bus.h
+ * @brief zbus channels carrying the timestamped sensor samples.
+ *
+ * Each acquisition thread publishes to its channel and knows nothing about
+ * the consumers. Consumers attach themselves with ZBUS_CHAN_ADD_OBS() in
+ * their own module and pick the delivery mode that suits them:
+ *
+ *  logger      listener            runs in the publisher, reads in place
+ *  stats       subscriber          own thread, claims the channel to read
+ *                                  the latest sample in place
+ *  BLE export  message subscriber  own thread, gets its own copy so a slow
+ *                                  link never holds the channel
+ *  shell       none                reads the latest sample on demand
+ */
+
+#ifndef SENSOR_BUS_H
+#define SENSOR_BUS_H
+
+#include <zephyr/zbus/zbus.h>
+
+#include "sensor_data.h"
+
+ZBUS_CHAN_DECLARE(ht_chan, lp_chan, imu_chan);
+
+#if defined(CONFIG_APP_IMU_STREAM)
+/* Every IMU sample at the full output data rate, imu_chan is decimated */
+ZBUS_CHAN_DECLARE(imu_raw_chan);
+#endif
+
+#if defined(CONFIG_APP_IMU_FUSION)
+ZBUS_CHAN_DECLARE(orient_chan);
+#endif
+
+#if defined(CONFIG_APP_VIBRATION)
+ZBUS_CHAN_DECLARE(vib_chan);
+#endif
+
+#if defined(CONFIG_APP_ANOMALY)
+ZBUS_CHAN_DECLARE(anomaly_chan);
+#endif
+
+#endif /* SENSOR_BUS_H */
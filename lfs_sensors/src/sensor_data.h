@@ -0,0 +1,182 @@
+/**
+ * @file sensor_data.h
+ * @brief Sensor sample and log record layouts shared by all modules.
+ *
+ * The acquisition threads publish timestamped samples on the sensor bus;
+ * the logger aligns the latest samples of every channel to one time base
+ * and stores the result as a sensors_shared_buf record.
+ */
+
+#ifndef SENSOR_DATA_H
+#define SENSOR_DATA_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+//==============================================================================
+// Sensor Values
+//==============================================================================
+
+/*
+ * Structures of HTS221, LPS22HB and LSM6DSL. They only hold doubles so the
+ * aligner can treat them as plain arrays.
+ */
+
+typedef struct {
+        double humidity;
+        double temperature;
+} hum_temp_data;
+
+typedef struct {
+        double pressure;
+} press_data;
+
+typedef struct {
+    double x, y, z;
+} imu_data_t;
+
+typedef struct {
+        imu_data_t accel;
+        imu_data_t gyro;
+} imu_sensor_data;
+
+//==============================================================================
+// Timestamped Samples
+//==============================================================================
+
+/*
+ * Samples as published by the acquisition threads, stamped at the middle of
+ * the bus transfer that read them.
+ */
+
+typedef struct {
+        uint64_t ts_ns;
+        hum_temp_data data;
+} hum_temp_sample;
+
+typedef struct {
+        uint64_t ts_ns;
+        press_data data;
+} press_sample;
+
+typedef struct {
+        uint64_t ts_ns;
+        imu_sensor_data data;
+} imu_sample;
+
+//==============================================================================
+// Orientation
+//==============================================================================
+
+/*
+ * Output of the IMU fusion stage, stamped with the IMU sample it was last
+ * updated with. Single precision like the filter that computes it.
+ */
+
+typedef struct {
+        uint64_t ts_ns;
+        float q[4];				// w, x, y, z
+        float roll, pitch, yaw;			// Degrees
+} orient_sample;
+
+//==============================================================================
+// Vibration Features
+//==============================================================================
+
+#define VIB_BANDS	4
+
+/*
+ * Spectrum summary of one window of accelerometer magnitude, DC removed.
+ * The bands split 0 Hz to the Nyquist frequency in equal widths.
+ */
+
+typedef struct {
+        float rms;				// m/s^2
+        float peak_hz;				// Strongest spectral line
+        float band_rms[VIB_BANDS];		// m/s^2, low to high
+} vib_features;
+
+typedef struct {
+        uint64_t ts_ns;				// Last sample of the window
+        vib_features features;
+} vib_sample;
+
+//==============================================================================
+// Anomaly Events
+//==============================================================================
+
+enum anomaly_source {
+        ANOMALY_HUMIDITY,
+        ANOMALY_TEMPERATURE,
+        ANOMALY_PRESSURE,
+        ANOMALY_ACCEL,				// |accel| away from 1 g
+        ANOMALY_JERK,				// |d accel / dt|
+};
+
+typedef struct {
+        uint64_t ts_ns;				// Sample that fired
+        uint32_t source;			// enum anomaly_source
+        float value;				// Sample value, or deviation / jerk for the IMU
+        float score;				// z-score, or value over its limit for the IMU
+} anomaly_event;
+
+//==============================================================================
+// Log Record
+//==============================================================================
+
+/* Linear interpolation had to fall back to the nearest sample on a channel */
+#define SENSOR_REC_F_UNBRACKETED	BIT(0)
+/* vib holds the strongest vibration window of the log period */
+#define SENSOR_REC_F_VIB		BIT(1)
+/* An anomaly event was raised since the previous record */
+#define SENSOR_REC_F_ANOMALY		BIT(2)
+
+typedef struct {
+        uint64_t timestamp_ns;		// Common time base of all channels
+        uint32_t align_err_us;		// Worst distance to a real sample
+        uint32_t flags;			// SENSOR_REC_F_*
+        hum_temp_data hts_data;
+        press_data lps_data;
+        imu_sensor_data imu_data;
+        vib_features vib;			// Zero without SENSOR_REC_F_VIB
+} sensors_shared_buf;
+
+//==============================================================================
+// Timestamps
+//==============================================================================
+
+/**
+ * @brief Monotonic timestamp in nanoseconds since boot.
+ *
+ * Uses the 64-bit cycle counter where the timer has one, the tick counter
+ * otherwise.
+ */
+static inline uint64_t sensor_timestamp_ns(void)
+{
+#if defined(CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER)
+	return k_cyc_to_ns_floor64(k_cycle_get_64());
+#else
+	return k_ticks_to_ns_floor64(k_uptime_ticks());
+#endif
+}
+
+/**
+ * @brief Next sampling deadline on a grid of period_ms anchored at boot.
+ *
+ * Threads sampling at the same period share their deadlines, so their bus
+ * reads are issued together.
+ *
+ * Input: period_ms Sampling period.
+ *        lead_ms   Time needed before the deadline (sensor wake-up), the
+ *                  deadline is at least this far ahead.
+ *
+ * Returns: deadline in ms of uptime, for K_TIMEOUT_ABS_MS().
+ */
+static inline int64_t sensor_next_slot_ms(uint32_t period_ms, uint32_t lead_ms)
+{
+	int64_t t = k_uptime_get() + lead_ms;
+
+	return (t / period_ms + 1) * period_ms;
+}
+
+#endif /* SENSOR_DATA_H */
@@ -0,0 +1,50 @@
+/**
+ * @file log_store.h
+ * @brief Storage backend interface of the sensor logger.
+ *
+ * The logger only appends fixed-size records and reads back the segment it
+ * is currently appending to. Exactly one backend is built, selected with
+ * the APP_STORE_BACKEND Kconfig choice, and provides the log_store
+ * instance:
+ *
+ *  LittleFS  rotating sensorN.log files on the lfs1 partition (store_lfs.c)
+ *  FCB       sector-rotating circular log written straight into the lfs1
+ *            partition, with zero-copy reads on memory-mapped flash
+ *            (store_fcb.c)
+ */
+
+#ifndef LOG_STORE_H
+#define LOG_STORE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Record visitor.
+ *
+ * Input: rec		Record contents, only valid during the call. Points
+ *			straight into flash when the backend can map it.
+ *	  len		Record length in bytes.
+ *	  user_data	Caller context.
+ *
+ * Returns: 0 to continue, non-zero to stop the walk.
+ */
+typedef int (*log_store_visit_t)(const void *rec, size_t len, void *user_data);
+
+struct log_store_backend {
+	/** Backend name for log messages */
+	const char *name;
+
+	/** Prepare the partition for records of rec_len bytes, formatting it if unusable */
+	int (*init)(size_t rec_len);
+
+	/** Append one record, reclaiming the oldest segment when full */
+	int (*append)(const void *rec);
+
+	/** Visit the committed records of the segment being appended to */
+	int (*walk_active)(log_store_visit_t visit, void *user_data);
+};
+
+/** The backend selected with APP_STORE_BACKEND */
+extern const struct log_store_backend log_store;
+
+#endif /* LOG_STORE_H */
@@ -0,0 +1,233 @@
+/**
+ * @file store_fcb.c
+ * @brief FCB circular log storage backend of the sensor logger.
+ *
+ * Records are appended straight into the lfs1 partition with the Flash
+ * Circular Buffer: every flash sector is a segment, the active sector
+ * fills up sequentially and, once the partition is full, the oldest
+ * sector is erased and reused. There is no filesystem metadata to update,
+ * so an append costs one entry header plus the record itself.
+ *
+ * On memory-mapped internal flash the records are handed to the reader in
+ * place (APP_STORE_FCB_ZERO_COPY), otherwise through a bounce buffer.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#include "log_store.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(store_fcb, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define STORE_PARTITION		DT_NODELABEL(lfs1_partition)
+#define STORE_AREA_ID		FIXED_PARTITION_ID(lfs1_partition)
+#define STORE_FCB_MAGIC		0x53454e53	// "SENS"
+#define RECORD_MAX		128		// Largest record, rounded up to the write block
+
+#if defined(CONFIG_APP_STORE_FCB_ZERO_COPY)
+#define STORE_FLASH		DT_MTD_FROM_FIXED_PARTITION(STORE_PARTITION)
+#if DT_NODE_HAS_COMPAT(STORE_FLASH, soc_nv_flash)
+/* Internal flash is readable at its devicetree address */
+#define STORE_MAPPED_BASE	(DT_REG_ADDR(STORE_FLASH) + DT_REG_ADDR(STORE_PARTITION))
+#endif
+#endif
+
+#if defined(STORE_MAPPED_BASE)
+#define STORE_READ_MODE		"zero-copy"
+#else
+#define STORE_READ_MODE		"buffered"
+#endif
+
+//==============================================================================
+// Static Data
+//==============================================================================
+
+static struct flash_sector sectors[CONFIG_APP_STORE_FCB_MAX_SECTORS];
+static struct fcb fcb;
+static size_t record_len;
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+/**
+ * @brief Erase the whole partition.
+ *
+ * Returns: 0  Success
+ * 	   <0  Error code
+ */
+static int store_fcb_erase(void)
+{
+	const struct flash_area *fa;
+	int rc;
+
+	rc = flash_area_open(STORE_AREA_ID, &fa);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = flash_area_flatten(fa, 0, fa->fa_size);
+	flash_area_close(fa);
+	return rc;
+}
+
+struct walk_ctx {
+	log_store_visit_t visit;
+	void *user_data;
+};
+
+static int store_fcb_walk_cb(struct fcb_entry_ctx *loc_ctx, void *arg)
+{
+	struct walk_ctx *ctx = arg;
+	uint16_t len = loc_ctx->loc.fe_data_len;
+
+#if defined(STORE_MAPPED_BASE)
+	const void *rec = (const void *)(STORE_MAPPED_BASE + FCB_ENTRY_FA_DATA_OFF(loc_ctx->loc));
+
+	return ctx->visit(rec, len, ctx->user_data);
+#else
+	uint8_t rec[RECORD_MAX];
+	int rc;
+
+	if (len > sizeof(rec)) {
+		return -EINVAL;
+	}
+	rc = flash_area_read(loc_ctx->fap, FCB_ENTRY_FA_DATA_OFF(loc_ctx->loc), rec, len);
+	if (rc < 0) {
+		return rc;
+	}
+	return ctx->visit(rec, len, ctx->user_data);
+#endif
+}
+
+//==============================================================================
+// Backend Operations
+//==============================================================================
+
+/**
+ * @brief Attach the FCB to the partition, erasing it if it holds foreign data.
+ *
+ * Input: rec_len Size of every record.
+ *
+ * Returns: 0  Success
+ * 	   <0  Error code
+ */
+static int store_fcb_init(size_t rec_len)
+{
+	uint32_t sector_cnt = ARRAY_SIZE(sectors);
+	int rc;
+
+	if (rec_len > RECORD_MAX) {
+		return -EINVAL;
+	}
+	record_len = rec_len;
+
+	rc = flash_area_get_sectors(STORE_AREA_ID, &sector_cnt, sectors);
+	if (rc < 0) {
+		LOG_ERR("Unable to read the sector layout: %d", rc);
+		return rc;
+	}
+
+	fcb.f_magic = STORE_FCB_MAGIC;
+	fcb.f_version = 1;
+	fcb.f_sector_cnt = MIN(sector_cnt, UINT8_MAX);
+	fcb.f_scratch_cnt = 0;
+	fcb.f_sectors = sectors;
+
+	rc = fcb_init(STORE_AREA_ID, &fcb);
+	if (rc < 0) {
+		// Most likely LittleFS data from the other backend
+		LOG_INF("No FCB log found (%d), erasing the partition", rc);
+		rc = store_fcb_erase();
+		if (rc == 0) {
+			rc = fcb_init(STORE_AREA_ID, &fcb);
+		}
+	}
+	if (rc < 0) {
+		LOG_ERR("FCB init failed: %d", rc);
+		return rc;
+	}
+	if (ROUND_UP(rec_len, fcb.f_align) > RECORD_MAX) {
+		return -EINVAL;
+	}
+
+	LOG_INF("FCB log on %u sectors of %u bytes, " STORE_READ_MODE " reads",
+		fcb.f_sector_cnt, sectors[0].fs_size);
+	return 0;
+}
+
+/**
+ * @brief Append a record, erasing the oldest sector when the log is full.
+ *
+ * Input: rec Record of the size given to init.
+ *
+ * Returns: 0  Success
+ * 	   <0  Error code
+ */
+static int store_fcb_append(const void *rec)
+{
+	uint8_t buf[RECORD_MAX];
+	struct fcb_entry loc;
+	size_t write_len = ROUND_UP(record_len, fcb.f_align);
+	int rc;
+
+	rc = fcb_append(&fcb, record_len, &loc);
+	if (rc == -ENOSPC) {
+		rc = fcb_rotate(&fcb);
+		if (rc == 0) {
+			rc = fcb_append(&fcb, record_len, &loc);
+		}
+	}
+	if (rc < 0) {
+		return rc;
+	}
+
+	// Writes must cover whole write blocks, pad with the erased value
+	memcpy(buf, rec, record_len);
+	memset(&buf[record_len], fcb.f_erase_value, write_len - record_len);
+	rc = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), buf, write_len);
+	if (rc < 0) {
+		return rc;
+	}
+	return fcb_append_finish(&fcb, &loc);
+}
+
+/**
+ * @brief Visit the records of the sector being appended to.
+ */
+static int store_fcb_walk_active(log_store_visit_t visit, void *user_data)
+{
+	struct walk_ctx ctx = { .visit = visit, .user_data = user_data };
+	int rc;
+
+	rc = fcb_walk(&fcb, fcb.f_active.fe_sector, store_fcb_walk_cb, &ctx);
+	return rc < 0 ? rc : 0;
+}
+
+//==============================================================================
+// Backend Definition
+//==============================================================================
+
+const struct log_store_backend log_store = {
+	.name = "fcb",
+	.init = store_fcb_init,
+	.append = store_fcb_append,
+	.walk_active = store_fcb_walk_active,
+};
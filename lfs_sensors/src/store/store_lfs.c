@@ -0,0 +1,286 @@
+/**
+ * @file store_lfs.c
+ * @brief LittleFS storage backend of the sensor logger.
+ *
+ * Records are appended to /lfs/sensorN.log. A file is closed for writing
+ * once it reaches FILE_SIZE bytes and the next one is started; after
+ * MAX_FILES files the oldest one is deleted and reused.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/fs/littlefs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <errno.h>
+#include <stdio.h>
+
+#include "log_store.h"
+#include "lfs_profile.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(store_lfs, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define FILE_SIZE			1024		// Max file size in bytes
+#define MAX_FILES			10		// Maximum number of log files
+#define RECORD_MAX			128		// Largest record read back
+
+//==============================================================================
+// LittleFS Mount & Flash Management
+//==============================================================================
+
+#if LFS_PROFILE_FROM_FSTAB
+
+/* Geometry and mount point come from the lfs1 fstab entry of the overlay */
+FS_FSTAB_DECLARE_ENTRY(LFS_FSTAB_NODE);
+
+static struct fs_mount_t *const lfs_mp = &FS_FSTAB_ENTRY(LFS_FSTAB_NODE);
+
+#else
+
+/* LittleFS configuration of the board profile (APP_LFS_PROFILE) */
+FS_LITTLEFS_DECLARE_CUSTOM_CONFIG(lfs1, 4, LFS_PROFILE_READ_SIZE, LFS_PROFILE_PROG_SIZE,
+				  LFS_PROFILE_CACHE_SIZE, LFS_PROFILE_LOOKAHEAD_SIZE);
+
+/* LittleFS mount point */
+static struct fs_mount_t lfs_mount_pt = {
+	.type = FS_LITTLEFS,
+	.fs_data = &lfs1,
+	.storage_dev = (void *)FIXED_PARTITION_ID(lfs1_partition),
+	.mnt_point = "/lfs",
+};
+
+static struct fs_mount_t *const lfs_mp = &lfs_mount_pt;
+
+#endif
+
+/**
+ * @brief Erase flash area used by LittleFS.
+ *
+ * Input: id Partition ID of the flash area to erase.
+ *
+ * Returns: 0  Success
+ * 	   <0  Error code
+ */
+
+static int littlefs_flash_erase(unsigned int id)
+{
+        const struct flash_area *pfa;
+        int rc;
+
+        rc = flash_area_open(id, &pfa);
+        if (rc < 0) {
+                LOG_ERR("FAIL: unable to find flash area %u: %d\n",id, rc);
+                return rc;
+        }
+
+        LOG_INF("Area %u at 0x%x on %s for %u bytes\n", id, (unsigned int)pfa->fa_off, pfa->fa_dev->name,(unsigned int)pfa->fa_size);
+
+        /* Optional wipe flash contents */
+        rc = flash_area_flatten(pfa, 0, pfa->fa_size);
+        LOG_INF("Erasing flash area ... %d", rc);
+
+        flash_area_close(pfa);
+        return rc;
+}
+
+/**
+ * @brief Mount LittleFS at given mount point.
+ *
+ * Attempts to mount; if it fails, erases flash and retries.
+ *
+ * Input: mp Mount point structure.
+ *
+ * Returns:  0  Success
+ *	    <0  Error code
+ */
+
+static int littlefs_mount(struct fs_mount_t *mp)
+{
+        int rc;
+
+        /* Do not mount if auto-mount has been enabled */
+        rc = fs_mount(mp);
+        if (rc == -EBUSY) {
+		/* Already mounted from the fstab entry, never erase it */
+		rc = 0;
+	}
+        if (rc < 0) {
+		rc = littlefs_flash_erase((uintptr_t)mp->storage_dev);
+		if (rc < 0) {
+			LOG_ERR("Flash erase failed.");
+			return rc;
+		}
+		rc = fs_mount(mp);
+                if (rc < 0) {
+			LOG_ERR("FAIL: mount id %" PRIuPTR " at %s: %d\n",(uintptr_t)mp->storage_dev, mp->mnt_point, rc);
+			return rc;
+		}
+		LOG_INF("%s is mounted: %d\n", mp->mnt_point, rc);
+        } else {
+		LOG_INF("%s is mounted: %d\n", mp->mnt_point, rc);
+	}
+	return 0;
+}
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+static size_t record_len;
+static uint8_t file_num = 1;
+
+static void log_file_name(char *buf, size_t len, uint8_t num)
+{
+	snprintf(buf, len, "%s/sensor%d.log", lfs_mp->mnt_point, num);
+}
+
+/**
+ * @brief Size of a log file.
+ *
+ * Returns: size in bytes, 0 if the file does not exist.
+ */
+static off_t log_file_size(uint8_t num)
+{
+	struct fs_dirent entry;
+	char filename[32];
+
+	log_file_name(filename, sizeof(filename), num);
+	if (fs_stat(filename, &entry) < 0) {
+		return 0;
+	}
+	return entry.size;
+}
+
+//==============================================================================
+// Backend Operations
+//==============================================================================
+
+/**
+ * @brief Mount the log partition and find the file to append to.
+ *
+ * Input: rec_len Size of every record.
+ *
+ * Returns: 0  Success
+ * 	   <0  Error code
+ */
+static int store_lfs_init(size_t rec_len)
+{
+	int rc;
+
+	if (rec_len > RECORD_MAX) {
+		return -EINVAL;
+	}
+	record_len = rec_len;
+
+#if !LFS_PROFILE_FROM_FSTAB
+	lfs1.cfg.block_cycles = LFS_PROFILE_BLOCK_CYCLES;
+#endif
+	LOG_INF("LittleFS read %d prog %d cache %d lookahead %d block_cycles %d",
+		LFS_PROFILE_READ_SIZE, LFS_PROFILE_PROG_SIZE, LFS_PROFILE_CACHE_SIZE,
+		LFS_PROFILE_LOOKAHEAD_SIZE, LFS_PROFILE_BLOCK_CYCLES);
+
+	rc = littlefs_mount(lfs_mp);
+	if (rc < 0) {
+		LOG_ERR("FAIL: mount id %" PRIuPTR " at %s: %d",(uintptr_t)lfs_mp->storage_dev, lfs_mp->mnt_point, rc);
+		return rc;
+	}
+
+	// Continue in the first file that still has room
+	for (file_num = 1; file_num <= MAX_FILES; file_num++) {
+		if (log_file_size(file_num) < FILE_SIZE) {
+			break;
+		}
+	}
+	if (file_num > MAX_FILES) {
+		file_num = MAX_FILES;
+	}
+	return 0;
+}
+
+/**
+ * @brief Append a record, rotating to the next file when the current one is full.
+ *
+ * Input: rec Record of the size given to init.
+ *
+ * Returns: 0  Success
+ * 	   <0  Error code
+ */
+static int store_lfs_append(const void *rec)
+{
+	struct fs_file_t file;
+	char filename[32];
+	int ret;
+
+	if (log_file_size(file_num) >= FILE_SIZE) {
+		file_num = file_num % MAX_FILES + 1;
+		log_file_name(filename, sizeof(filename), file_num);
+		// Reclaim the oldest file of the ring
+		fs_unlink(filename);
+	}
+
+	log_file_name(filename, sizeof(filename), file_num);
+	fs_file_t_init(&file);
+	ret = fs_open(&file, filename, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
+	if (ret < 0) {
+		LOG_ERR("Failed to open file %s: %d", filename, ret);
+		return ret;
+	}
+
+	ret = fs_write(&file, rec, record_len);
+	fs_close(&file);
+	if (ret != (ssize_t)record_len) {
+		LOG_ERR("Failed to write file %s: %d", filename, ret);
+		return ret < 0 ? ret : -EIO;
+	}
+	return 0;
+}
+
+/**
+ * @brief Read back the records of the file being appended to.
+ */
+static int store_lfs_walk_active(log_store_visit_t visit, void *user_data)
+{
+	uint8_t rec[RECORD_MAX];
+	struct fs_file_t file;
+	char filename[32];
+	int ret;
+
+	log_file_name(filename, sizeof(filename), file_num);
+	fs_file_t_init(&file);
+	ret = fs_open(&file, filename, FS_O_READ);
+	if (ret < 0) {
+		return ret;
+	}
+
+	while ((ret = fs_read(&file, rec, record_len)) == (ssize_t)record_len) {
+		if (visit(rec, record_len, user_data) != 0) {
+			break;
+		}
+	}
+	fs_close(&file);
+	return ret < 0 ? ret : 0;
+}
+
+//==============================================================================
+// Backend Definition
+//==============================================================================
+
+const struct log_store_backend log_store = {
+	.name = "littlefs",
+	.init = store_lfs_init,
+	.append = store_lfs_append,
+	.walk_active = store_lfs_walk_active,
+};
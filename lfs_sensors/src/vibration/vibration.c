@@ -0,0 +1,218 @@
+/**
+ * @file vibration.c
+ * @brief Vibration spectrum features from blocks of accelerometer samples.
+ *
+ * A zbus listener on the full rate IMU channel collects the accelerometer
+ * magnitude into ping-pong blocks of APP_VIB_BLOCK_SIZE samples. Each full
+ * block is handed to this module's thread, which runs a Hann windowed real
+ * FFT with the CMSIS-DSP kernels and publishes RMS, peak frequency and band
+ * RMS values on vib_chan. A block that completes while the previous one is
+ * still being processed is dropped and counted.
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/zbus/zbus.h>
+#include <arm_math.h>
+#include <math.h>
+
+#include "sensor_bus.h"
+
+//==============================================================================
+// Logging Module Register
+//==============================================================================
+
+LOG_MODULE_REGISTER(vibration, CONFIG_APP_LOG_LEVEL);
+
+//==============================================================================
+// Configuration Constants
+//==============================================================================
+
+#define VIB_THREAD_PRIORITY	6		// Below the sensor threads
+#define VIB_THREAD_STACK_SIZE	1536
+#define VIB_LOG_PERIOD_MS	1000		// At most one feature line per period
+
+#define VIB_N			CONFIG_APP_VIB_BLOCK_SIZE
+#define VIB_BINS		(VIB_N / 2)	// One-sided, DC to just below Nyquist
+#define VIB_BAND_BINS		((VIB_BINS - 1) / VIB_BANDS)
+#define VIB_BIN_HZ		((float)CONFIG_APP_IMU_ODR_HZ / VIB_N)
+#define VIB_BUDGET_US		((uint32_t)((uint64_t)VIB_N * USEC_PER_SEC / CONFIG_APP_IMU_ODR_HZ))
+
+BUILD_ASSERT(IS_POWER_OF_TWO(VIB_N) && VIB_N >= 32 && VIB_N <= 4096,
+	     "arm_rfft_fast_f32 needs a power of two between 32 and 4096");
+
+//==============================================================================
+// Block Buffers
+//==============================================================================
+
+/*
+ * The listener fills blocks[fill], the thread owns blocks[!fill] while
+ * busy is set. The FFT runs in place on the block.
+ */
+static float blocks[2][VIB_N];
+static uint8_t fill;
+static size_t fill_len;
+static uint64_t block_ts_ns;
+static atomic_t busy;
+static uint32_t overruns;
+
+static K_SEM_DEFINE(block_ready_sem, 0, 1);
+
+//==============================================================================
+// Processing State
+//==============================================================================
+
+static arm_rfft_fast_instance_f32 rfft;
+static float window[VIB_N];
+static float window_pow;			// Sum of the squared window
+static float spectrum[VIB_N];
+static float power[VIB_BINS];
+
+//==============================================================================
+// Listener
+//==============================================================================
+
+/**
+ * @brief zbus listener, runs in the IMU thread for every raw sample.
+ *
+ * Input: chan imu_raw_chan.
+ */
+static void vib_listener_cb(const struct zbus_channel *chan)
+{
+	const imu_sample *s = zbus_chan_const_msg(chan);
+	const imu_data_t *a = &s->data.accel;
+
+	blocks[fill][fill_len++] = sqrtf(a->x * a->x + a->y * a->y + a->z * a->z);
+	if (fill_len < VIB_N) {
+		return;
+	}
+	fill_len = 0;
+
+	if (!atomic_cas(&busy, 0, 1)) {
+		overruns++;
+		return;
+	}
+	block_ts_ns = s->ts_ns;
+	fill ^= 1;
+	k_sem_give(&block_ready_sem);
+}
+
+ZBUS_LISTENER_DEFINE(vib_lis, vib_listener_cb);
+ZBUS_CHAN_ADD_OBS(imu_raw_chan, vib_lis, 1);
+
+//==============================================================================
+// Internal Helper Functions
+//==============================================================================
+
+static void vib_window_init(void)
+{
+	window_pow = 0.0f;
+	for (size_t i = 0; i < VIB_N; i++) {
+		window[i] = 0.5f - 0.5f * cosf(2.0f * PI * i / VIB_N);
+		window_pow += window[i] * window[i];
+	}
+}
+
+/**
+ * @brief RMS of the bins [lo, lo + n) of the one-sided power spectrum.
+ *
+ * Scaled by Parseval and the window power so a band holding all the
+ * energy reports the time domain RMS.
+ */
+static float band_rms(size_t lo, size_t n)
+{
+	float mean;
+
+	arm_mean_f32(&power[lo], n, &mean);
+	return sqrtf(2.0f * mean * n / (VIB_N * window_pow));
+}
+
+/**
+ * @brief Extract the features of one block, destroys the block.
+ *
+ * Input:  x	VIB_N accelerometer magnitudes.
+ * Output: f	Features.
+ */
+static void vib_process(float *x, vib_features *f)
+{
+	float mean, peak;
+	uint32_t peak_bin;
+
+	// Gravity and sensor offset are the DC component
+	arm_mean_f32(x, VIB_N, &mean);
+	arm_offset_f32(x, -mean, x, VIB_N);
+	arm_rms_f32(x, VIB_N, &f->rms);
+
+	arm_mult_f32(x, window, x, VIB_N);
+	arm_rfft_fast_f32(&rfft, x, spectrum, 0);
+
+	// spectrum[0..1] hold the real DC and Nyquist terms, complex bins follow
+	power[0] = 0.0f;
+	arm_cmplx_mag_squared_f32(&spectrum[2], &power[1], VIB_BINS - 1);
+
+	arm_max_f32(&power[1], VIB_BINS - 1, &peak, &peak_bin);
+	f->peak_hz = (peak_bin + 1) * VIB_BIN_HZ;
+
+	for (size_t b = 0; b < VIB_BANDS; b++) {
+		size_t lo = 1 + b * VIB_BAND_BINS;
+		size_t n = (b == VIB_BANDS - 1) ? VIB_BINS - lo : VIB_BAND_BINS;
+
+		f->band_rms[b] = band_rms(lo, n);
+	}
+}
+
+//==============================================================================
+// Thread
+//==============================================================================
+
+static void vib_thread(void *, void *, void *)
+{
+	vib_sample out;
+
+	if (arm_rfft_fast_init_f32(&rfft, VIB_N) != ARM_MATH_SUCCESS) {
+		LOG_ERR("No FFT tables for %d points", VIB_N);
+		return;
+	}
+	vib_window_init();
+	LOG_INF("Vibration: %d point blocks at %d Hz, %.2f Hz bins, %u us per block",
+		VIB_N, CONFIG_APP_IMU_ODR_HZ, (double)VIB_BIN_HZ, VIB_BUDGET_US);
+
+	int64_t next_log_ms = 0;
+	uint32_t cpu_max_us = 0;
+
+	while (1) {
+		uint32_t start, cpu_us;
+
+		k_sem_take(&block_ready_sem, K_FOREVER);
+
+		start = k_cycle_get_32();
+		vib_process(blocks[!fill], &out.features);
+		cpu_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+		out.ts_ns = block_ts_ns;
+		atomic_set(&busy, 0);
+
+		zbus_chan_pub(&vib_chan, &out, K_MSEC(100));
+
+		/* Blocks come several times a second, log the worst CPU time of the period */
+		cpu_max_us = MAX(cpu_max_us, cpu_us);
+		if (k_uptime_get() < next_log_ms) {
+			continue;
+		}
+		next_log_ms = k_uptime_get() + VIB_LOG_PERIOD_MS;
+		LOG_INF("vib: rms %.3f peak %.1f Hz, bands %.3f %.3f %.3f %.3f | max %u/%u us, %u dropped",
+			(double)out.features.rms, (double)out.features.peak_hz,
+			(double)out.features.band_rms[0], (double)out.features.band_rms[1],
+			(double)out.features.band_rms[2], (double)out.features.band_rms[3],
+			cpu_max_us, VIB_BUDGET_US, overruns);
+		cpu_max_us = 0;
+	}
+}
+
+K_THREAD_DEFINE(vib_tid, VIB_THREAD_STACK_SIZE, vib_thread,
+		NULL, NULL, NULL, VIB_THREAD_PRIORITY, 0, 0);
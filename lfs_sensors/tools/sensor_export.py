@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""Host client for the lfs_sensors binary log export protocol.
+
+Frames are COBS(payload || CRC16 little endian) + 0x00, the CRC matching
+Zephyr's crc16_ccitt() seeded with 0xFFFF. See src/export/log_export.h for
+the opcodes.
+
+  sensor_export.py /dev/ttyACM1 ping
+  sensor_export.py /dev/ttyACM1 list
+  sensor_export.py /dev/ttyACM1 get sensor1.log -o sensor1.log
+  sensor_export.py /dev/ttyACM1 get sensor1.log --csv
+
+Requires pyserial.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import serial
+
+OP_PING = 0x01
+OP_LIST = 0x02
+OP_READ = 0x03
+OP_STREAM = 0x04
+OP_ACK = 0x05
+OP_RSP = 0x80
+OP_DATA = OP_RSP | OP_STREAM
+OP_END = 0x86
+OP_ERROR = 0xFF
+
+# sensors_shared_buf: aligned timestamp (ns), alignment error (us), flags,
+# humidity, temperature, pressure, accel xyz, gyro xyz, vibration RMS,
+# peak frequency and four band RMS values
+RECORD = struct.Struct("<QII9d6f")
+RECORD_FIELDS = ("timestamp_ns", "align_err_us", "flags", "humidity", "temperature", "pressure",
+                 "accel_x", "accel_y", "accel_z", "gyro_x", "gyro_y", "gyro_z",
+                 "vib_rms", "vib_peak_hz", "vib_band0", "vib_band1", "vib_band2", "vib_band3")
+
+
+def crc16_ccitt(data, seed=0xFFFF):
+    crc = seed
+    for byte in data:
+        e = (crc ^ byte) & 0xFF
+        f = (e ^ (e << 4)) & 0xFF
+        crc = (crc >> 8) ^ (f << 8) ^ (f << 3) ^ (f >> 4)
+        crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos, code = 0, 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            code += 1
+        if not byte or code == 0xFF:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+    out[code_pos] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        pos += 1
+        if code == 0 or pos + code - 1 > len(data):
+            raise ValueError("bad COBS block")
+        out += data[pos:pos + code - 1]
+        pos += code - 1
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class ExportError(Exception):
+    pass
+
+
+class ExportLink:
+    def __init__(self, port, baud, timeout):
+        self.ser = serial.Serial(port, baud, timeout=timeout)
+        self.timeout = timeout
+        self.seq = 0
+        self.rx = bytearray()
+        self.crc_errors = 0
+        self.max_payload = 240
+
+    def send(self, op, body=b""):
+        self.seq = (self.seq + 1) & 0xFF
+        payload = bytes([op, self.seq]) + body
+        crc = crc16_ccitt(payload)
+        self.ser.write(cobs_encode(payload + struct.pack("<H", crc)) + b"\0")
+        return self.seq
+
+    def recv(self):
+        """Return the next valid (op, seq, body), or None on timeout."""
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            end = self.rx.find(0)
+            if end < 0:
+                self.rx += self.ser.read(max(1, self.ser.in_waiting))
+                continue
+            frame, self.rx = bytes(self.rx[:end]), self.rx[end + 1:]
+            try:
+                payload = cobs_decode(frame)
+            except ValueError:
+                self.crc_errors += 1
+                continue
+            if len(payload) < 4 or \
+                    crc16_ccitt(payload[:-2]) != struct.unpack("<H", payload[-2:])[0]:
+                self.crc_errors += 1
+                continue
+            return payload[0], payload[1], payload[2:-2]
+        return None
+
+    def request(self, op, body=b""):
+        seq = self.send(op, body)
+        while True:
+            rsp = self.recv()
+            if rsp is None:
+                raise ExportError("timeout waiting for 0x%02x" % op)
+            rop, rseq, rbody = rsp
+            if rseq != seq:
+                continue
+            if rop == OP_ERROR:
+                raise ExportError("0x%02x failed: %d" % (rbody[0], struct.unpack("<h", rbody[1:3])[0]))
+            return rbody
+
+    def ping(self):
+        version, self.max_payload = struct.unpack("<HH", self.request(OP_PING))
+        return version, self.max_payload
+
+    def list(self):
+        files = []
+        while True:
+            body = self.request(OP_LIST, struct.pack("<H", len(files)))
+            if not body:
+                return files
+            pos = 0
+            while pos < len(body):
+                size, name_len = struct.unpack_from("<IB", body, pos)
+                files.append((body[pos + 5:pos + 5 + name_len].decode(), size))
+                pos += 5 + name_len
+
+    def stream(self, name, window, progress=None):
+        """Stream a file, restarting from the last good offset on errors."""
+        data = bytearray()
+        retries = 0
+        while True:
+            seq = self.send(OP_STREAM, struct.pack("<IB", len(data), window) + name.encode())
+            while True:
+                rsp = self.recv()
+                if rsp is None:
+                    break
+                op, rseq, body = rsp
+                if rseq != seq:
+                    continue
+                if op == OP_ERROR:
+                    raise ExportError("stream failed: %d" % struct.unpack("<h", body[1:3])[0])
+                offset = struct.unpack_from("<I", body)[0]
+                if op == OP_END:
+                    if offset == len(data):
+                        return bytes(data)
+                    break
+                if op != OP_DATA:
+                    continue
+                if offset != len(data):
+                    # Lost a frame: abort the stream and restart from here
+                    break
+                data += body[4:]
+                self.send(OP_ACK, struct.pack("<I", len(data)))
+                if progress:
+                    progress(len(data))
+            retries += 1
+            if retries > 5:
+                raise ExportError("stream of %s gave up at %d bytes" % (name, len(data)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port")
+    parser.add_argument("-b", "--baud", type=int, default=1000000)
+    parser.add_argument("-t", "--timeout", type=float, default=2.0)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    sub.add_parser("ping")
+    sub.add_parser("list")
+    get = sub.add_parser("get")
+    get.add_argument("name")
+    get.add_argument("-o", "--output")
+    get.add_argument("-w", "--window", type=int, default=8)
+    get.add_argument("--csv", action="store_true", help="decode sensor records as CSV")
+    args = parser.parse_args()
+
+    link = ExportLink(args.port, args.baud, args.timeout)
+    try:
+        if args.cmd == "ping":
+            print("protocol %d, max payload %d" % link.ping())
+        elif args.cmd == "list":
+            for name, size in link.list():
+                print("%8d  %s" % (size, name))
+        else:
+            start = time.monotonic()
+            data = link.stream(args.name, args.window)
+            elapsed = time.monotonic() - start
+            print("%s: %d bytes in %.2f s (%.1f kB/s), %d CRC errors" %
+                  (args.name, len(data), elapsed, len(data) / elapsed / 1000, link.crc_errors),
+                  file=sys.stderr)
+            if args.csv:
+                out = open(args.output, "w") if args.output else sys.stdout
+                out.write(",".join(RECORD_FIELDS) + "\n")
+                for rec in RECORD.iter_unpack(data[:len(data) - len(data) % RECORD.size]):
+                    out.write(",".join("%d" % v for v in rec[:3]) + "," +
+                              ",".join("%.4f" % v for v in rec[3:]) + "\n")
+            elif args.output:
+                with open(args.output, "wb") as out:
+                    out.write(data)
+            else:
+                sys.stdout.buffer.write(data)
+    except ExportError as err:
+        sys.exit(str(err))
+
+
+if __name__ == "__main__":
+    main()
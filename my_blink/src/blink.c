@@ -5,10 +5,93 @@
 #include <stdio.h>
 #include<zephyr/kernel.h>
 #include<zephyr/drivers/gpio.h>
+#include <errno.h>
+
+#include "blink.h"
 
 #define DELAY_MS 1000
 #define LED_LD4 DT_ALIAS(led3)
 
+#if DT_NODE_HAS_STATUS_OKAY(DT_ALIAS(pwm_led0)) && defined(CONFIG_PWM)
+
+#include "led_seq.h"
+
+/*PWM LED: patterns are compiled once and played by the sequencer*/
+static const struct pwm_dt_spec pwm_led = PWM_DT_SPEC_GET(DT_ALIAS(pwm_led0));
+static struct led_seq seq;
+
+/*Three quick flashes, then a slow blink forever*/
+static const uint8_t flash_levels[] = { 255, 0 };
+static struct led_seq_step flash_steps[2];
+static struct led_seq_step slow_steps[2];
+static struct led_seq_pattern flash = { .steps = flash_steps, .repeat = 3 };
+static struct led_seq_pattern slow = { .steps = slow_steps };
+
+int blink_start(void)
+{
+	int ret = led_seq_init(&seq, &pwm_led);
+
+	if(ret < 0){
+		return ret;
+	}
+
+	/*A fixed repeat count needs timed steps, so the flash is built from levels*/
+	ret = led_seq_compile_levels(flash_steps, ARRAY_SIZE(flash_steps),
+				     flash_levels, ARRAY_SIZE(flash_levels), 100);
+	if(ret < 0){
+		return ret;
+	}
+	flash.count = ret;
+
+	ret = led_seq_compile_blink(&seq, slow_steps, ARRAY_SIZE(slow_steps), DELAY_MS, DELAY_MS);
+	if(ret < 0){
+		return ret;
+	}
+	slow.count = ret;
+
+	ret = led_seq_start(&seq, &flash);
+	if(ret == 0){
+		ret = led_seq_queue(&seq, &slow);
+	}
+	return ret;
+}
+
+void blink_stop(void)
+{
+	led_seq_stop(&seq);
+}
+
+#else
+
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(LED_LD4, gpios);
 
+static void blink_expiry(struct k_timer *timer)
+{
+	gpio_pin_toggle_dt(&led);
+}
+
+static K_TIMER_DEFINE(blink_timer, blink_expiry, NULL);
+
+/*GPIO LED: toggled from a periodic timer instead of a sleeping loop*/
+int blink_start(void)
+{
+	int ret;
+
+	if(!gpio_is_ready_dt(&led)){
+		return -ENODEV;
+	}
+	ret = gpio_pin_configure_dt(&led, GPIO_OUTPUT_INACTIVE);
+	if(ret < 0){
+		return ret;
+	}
+	k_timer_start(&blink_timer, K_MSEC(DELAY_MS), K_MSEC(DELAY_MS));
+	return 0;
+}
+
+void blink_stop(void)
+{
+	k_timer_stop(&blink_timer);
+	gpio_pin_set_dt(&led, 0);
+}
 
+#endif
@@ -0,0 +1,14 @@
+/* blink.h custom blink
+ * Author: Stuti
+ * Date: 05-08-2025*/
+
+#ifndef BLINK_H
+#define BLINK_H
+
+/*Start blinking LD4 in the background, returns 0 or a negative errno*/
+int blink_start(void);
+
+/*Stop blinking and turn the LED off*/
+void blink_stop(void);
+
+#endif
@@ -0,0 +1,20 @@
+/* main.c custom blink
+ * Author: Stuti
+ * Date: 05-08-2025*/
+
+#include <stdio.h>
+#include<zephyr/kernel.h>
+
+#include "blink.h"
+
+int main(void)
+{
+	int ret = blink_start();
+
+	if(ret < 0){
+		printf("Blink failed to start: %d\n", ret);
+		return 0;
+	}
+	printf("Blinking on %s\n", CONFIG_BOARD_TARGET);
+	return 0;
+}
@@ -0,0 +1,13 @@
+/*Benchmark modes of the ping-pong sample
+ * Author: Stuti*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/*Handoff latency of the signalling primitives, prints a results table*/
+void latency_bench_run(void);
+
+/*Shared counter throughput per locking strategy and thread count*/
+void counter_bench_run(void);
+
+#endif
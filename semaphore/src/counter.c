@@ -0,0 +1,177 @@
+/*Shared counter contention benchmark
+ * N workers increment one counter as fast as they can for a fixed time,
+ * under k_mutex, k_spinlock, atomic_inc and per-thread shards merged
+ * periodically. Throughput is printed per strategy and thread count.
+ * Author: Stuti*/
+
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include "bench.h"
+
+#define MAX_THREADS	CONFIG_APP_COUNTER_MAX_THREADS
+#define DURATION_MS	CONFIG_APP_COUNTER_DURATION_MS
+#define MERGE_MS	CONFIG_APP_COUNTER_MERGE_MS
+#define STACK_SIZE	1024
+#define WORKER_PRIO	5
+
+/*Shards sit on their own cache line so workers never share one*/
+#define SHARD_ALIGN	64
+
+enum strategy {
+	STRAT_MUTEX,
+	STRAT_SPINLOCK,
+	STRAT_ATOMIC,
+	STRAT_SHARDED,
+	STRAT_COUNT,
+};
+
+static const char *const strategy_names[STRAT_COUNT] = {
+	"k_mutex", "k_spinlock", "atomic_inc", "sharded",
+};
+
+struct shard {
+	volatile uint32_t count;
+} __aligned(SHARD_ALIGN);
+
+/*Shared counter and its guards*/
+static uint32_t shared_counter;
+static struct k_mutex counter_mutex;
+static struct k_spinlock counter_lock;
+static atomic_t atomic_counter;
+static struct shard shards[MAX_THREADS];
+
+static atomic_t stop;
+static enum strategy strategy;
+static uint32_t worker_ops[MAX_THREADS];
+
+K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, MAX_THREADS, STACK_SIZE);
+static struct k_thread workers[MAX_THREADS];
+
+static void worker_thread(void *a, void *b, void *c)
+{
+	int id = POINTER_TO_INT(a);
+	uint32_t ops = 0;
+
+	while(!atomic_get(&stop)){
+		switch(strategy){
+		case STRAT_MUTEX:
+			k_mutex_lock(&counter_mutex, K_FOREVER);
+			shared_counter++;
+			k_mutex_unlock(&counter_mutex);
+			break;
+		case STRAT_SPINLOCK: {
+			k_spinlock_key_t key = k_spin_lock(&counter_lock);
+
+			shared_counter++;
+			k_spin_unlock(&counter_lock, key);
+			break;
+		}
+		case STRAT_ATOMIC:
+			atomic_inc(&atomic_counter);
+			break;
+		case STRAT_SHARDED:
+			/*Only this thread writes its shard, the merge only reads*/
+			shards[id].count++;
+			break;
+		default:
+			break;
+		}
+		ops++;
+	}
+	worker_ops[id] = ops;
+}
+
+/*Sum the shards into the shared counter, as a reader of the total would*/
+static uint32_t merge_shards(int threads)
+{
+	uint32_t total = 0;
+
+	for(int i = 0; i < threads; i++){
+		total += shards[i].count;
+	}
+	shared_counter = total;
+	return total;
+}
+
+static uint32_t counter_value(void)
+{
+	switch(strategy){
+	case STRAT_ATOMIC:
+		return atomic_get(&atomic_counter);
+	default:
+		return shared_counter;
+	}
+}
+
+/*Returns increments per second, or 0 if the final count did not add up*/
+static uint32_t run(enum strategy s, int threads)
+{
+	uint32_t expected = 0;
+	int64_t start;
+	int64_t elapsed;
+
+	strategy = s;
+	shared_counter = 0;
+	atomic_clear(&atomic_counter);
+	atomic_clear(&stop);
+	k_mutex_init(&counter_mutex);
+	for(int i = 0; i < MAX_THREADS; i++){
+		shards[i].count = 0;
+	}
+
+	start = k_uptime_get();
+	for(int i = 0; i < threads; i++){
+		k_thread_create(&workers[i], worker_stacks[i],
+				K_THREAD_STACK_SIZEOF(worker_stacks[i]), worker_thread,
+				INT_TO_POINTER(i), NULL, NULL, WORKER_PRIO, 0, K_NO_WAIT);
+	}
+
+	/*main runs at a higher priority than the workers and preempts them*/
+	while(k_uptime_get() - start < DURATION_MS){
+		k_msleep(s == STRAT_SHARDED ? MERGE_MS : DURATION_MS);
+		if(s == STRAT_SHARDED){
+			merge_shards(threads);
+		}
+	}
+	atomic_set(&stop, 1);
+	for(int i = 0; i < threads; i++){
+		k_thread_join(&workers[i], K_FOREVER);
+		expected += worker_ops[i];
+	}
+	elapsed = k_uptime_get() - start;
+
+	if(s == STRAT_SHARDED){
+		merge_shards(threads);
+	}
+	if(counter_value() != expected){
+		printk("%s with %d threads: counter %u, expected %u\n",
+		       strategy_names[s], threads, counter_value(), expected);
+		return 0;
+	}
+	return (uint64_t)expected * MSEC_PER_SEC / MAX(elapsed, 1);
+}
+
+void counter_bench_run(void)
+{
+	printk("Shared counter, %d ms per run, %u CPU(s), shard merge every %d ms\n",
+	       DURATION_MS, arch_num_cpus(), MERGE_MS);
+	printk("%-8s", "threads");
+	for(int s = 0; s < STRAT_COUNT; s++){
+		printk(" %12s", strategy_names[s]);
+	}
+	printk("   (increments/s)\n");
+
+	for(int threads = 1; threads <= MAX_THREADS; threads++){
+		printk("%-8d", threads);
+		for(int s = 0; s < STRAT_COUNT; s++){
+			printk(" %12u", run(s, threads));
+		}
+		printk("\n");
+	}
+	printk("Done\n");
+}
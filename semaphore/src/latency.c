@@ -0,0 +1,340 @@
+/*Ping-pong handoff latency benchmark
+ * The signalling thread stamps k_cycle_get_32() right before waking the
+ * other thread, which computes the delta as soon as it runs. Each
+ * primitive is run for every priority combination in both directions.
+ * Author: Stuti*/
+
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include "bench.h"
+
+#define ITERATIONS	CONFIG_APP_BENCH_ITERATIONS
+#define WARMUP		100
+#define HIST_BUCKETS	32
+#define STACK_SIZE	1024
+
+/*Channel 0 wakes pong, channel 1 wakes ping*/
+#define CH_PONG		0
+#define CH_PING		1
+
+/*log2 histogram of handoff latency in cycles*/
+struct hist {
+	uint32_t bucket[HIST_BUCKETS];
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+};
+
+struct prim {
+	const char *name;
+	void (*init)(void);
+	void (*signal)(int ch);
+	void (*wait)(int ch);
+	bool (*usable)(void);
+};
+
+static volatile uint32_t stamp[2];
+static struct hist hist[2];
+static const struct prim *cur;
+
+K_THREAD_STACK_DEFINE(ping_stack, STACK_SIZE);
+K_THREAD_STACK_DEFINE(pong_stack, STACK_SIZE);
+static struct k_thread ping_data;
+static struct k_thread pong_data;
+
+/*k_sem*/
+static struct k_sem sems[2];
+
+static void sem_init(void)
+{
+	k_sem_init(&sems[0], 0, 1);
+	k_sem_init(&sems[1], 0, 1);
+}
+
+static void sem_signal(int ch)
+{
+	k_sem_give(&sems[ch]);
+}
+
+static void sem_wait(int ch)
+{
+	k_sem_take(&sems[ch], K_FOREVER);
+}
+
+/*k_mutex guarding a flag, waiters block on a k_condvar*/
+static struct k_mutex cv_mutex;
+static struct k_condvar cvs[2];
+static bool cv_flag[2];
+
+static void cv_init(void)
+{
+	k_mutex_init(&cv_mutex);
+	k_condvar_init(&cvs[0]);
+	k_condvar_init(&cvs[1]);
+	cv_flag[0] = cv_flag[1] = false;
+}
+
+static void cv_signal(int ch)
+{
+	k_mutex_lock(&cv_mutex, K_FOREVER);
+	cv_flag[ch] = true;
+	k_condvar_signal(&cvs[ch]);
+	k_mutex_unlock(&cv_mutex);
+}
+
+static void cv_wait(int ch)
+{
+	k_mutex_lock(&cv_mutex, K_FOREVER);
+	while(!cv_flag[ch]){
+		k_condvar_wait(&cvs[ch], &cv_mutex, K_FOREVER);
+	}
+	cv_flag[ch] = false;
+	k_mutex_unlock(&cv_mutex);
+}
+
+/*k_event, one bit per channel*/
+static struct k_event ev;
+
+static void ev_init(void)
+{
+	k_event_init(&ev);
+}
+
+static void ev_signal(int ch)
+{
+	k_event_post(&ev, BIT(ch));
+}
+
+static void ev_wait(int ch)
+{
+	k_event_wait(&ev, BIT(ch), false, K_FOREVER);
+	k_event_clear(&ev, BIT(ch));
+}
+
+/*k_poll on a poll signal*/
+static struct k_poll_signal psig[2];
+
+static void poll_init(void)
+{
+	k_poll_signal_init(&psig[0]);
+	k_poll_signal_init(&psig[1]);
+}
+
+static void poll_signal(int ch)
+{
+	k_poll_signal_raise(&psig[ch], 0);
+}
+
+static void poll_wait(int ch)
+{
+	struct k_poll_event event = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL,
+			K_POLL_MODE_NOTIFY_ONLY, &psig[ch]);
+
+	k_poll(&event, 1, K_FOREVER);
+	k_poll_signal_reset(&psig[ch]);
+}
+
+#if defined(CONFIG_USERSPACE)
+/*k_futex, the word is set before waking and consumed with a CAS*/
+static struct k_futex futex[2];
+
+static void futex_init(void)
+{
+	atomic_set(&futex[0].val, 0);
+	atomic_set(&futex[1].val, 0);
+}
+
+static void futex_signal(int ch)
+{
+	atomic_set(&futex[ch].val, 1);
+	k_futex_wake(&futex[ch], false);
+}
+
+static void futex_wait(int ch)
+{
+	while(!atomic_cas(&futex[ch].val, 1, 0)){
+		k_futex_wait(&futex[ch], 0, K_FOREVER);
+	}
+}
+#endif
+
+/*Busy spinning on an atomic flag, only meaningful with a CPU per thread*/
+static atomic_t spin_flag[2];
+
+static void spin_init(void)
+{
+	atomic_clear(&spin_flag[0]);
+	atomic_clear(&spin_flag[1]);
+}
+
+static void spin_signal(int ch)
+{
+	atomic_set(&spin_flag[ch], 1);
+}
+
+static void spin_wait(int ch)
+{
+	while(!atomic_cas(&spin_flag[ch], 1, 0)){
+	}
+}
+
+static bool spin_usable(void)
+{
+	return arch_num_cpus() > 1;
+}
+
+static const struct prim prims[] = {
+	{ "k_sem", sem_init, sem_signal, sem_wait, NULL },
+	{ "k_mutex+condvar", cv_init, cv_signal, cv_wait, NULL },
+	{ "k_event", ev_init, ev_signal, ev_wait, NULL },
+	{ "k_poll", poll_init, poll_signal, poll_wait, NULL },
+#if defined(CONFIG_USERSPACE)
+	{ "k_futex", futex_init, futex_signal, futex_wait, NULL },
+#endif
+	{ "atomic spin", spin_init, spin_signal, spin_wait, spin_usable },
+};
+
+/*Priority combinations, lower value is higher priority*/
+static const struct {
+	const char *name;
+	int ping;
+	int pong;
+} prio_sets[] = {
+	{ "equal", 5, 5 },
+	{ "ping>pong", 4, 6 },
+	{ "pong>ping", 6, 4 },
+	{ "coop", K_PRIO_COOP(2), K_PRIO_COOP(2) },
+};
+
+static void hist_reset(struct hist *h)
+{
+	*h = (struct hist){ .min = UINT32_MAX };
+}
+
+static void hist_add(struct hist *h, uint32_t cycles)
+{
+	int idx = cycles ? 32 - __builtin_clz(cycles) : 0;
+
+	h->bucket[MIN(idx, HIST_BUCKETS - 1)]++;
+	h->count++;
+	h->sum += cycles;
+	h->min = MIN(h->min, cycles);
+	h->max = MAX(h->max, cycles);
+}
+
+/*Upper bound in cycles of the bucket holding the given percentile*/
+static uint32_t hist_percentile(const struct hist *h, uint32_t pct)
+{
+	uint32_t target = DIV_ROUND_UP((uint64_t)h->count * pct, 100);
+	uint32_t seen = 0;
+
+	for(int i = 0; i < HIST_BUCKETS; i++){
+		seen += h->bucket[i];
+		if(seen >= target && seen > 0){
+			return i ? MIN((uint64_t)BIT64(i) - 1, h->max) : 0;
+		}
+	}
+	return h->max;
+}
+
+static uint32_t cyc_to_ns(uint64_t cycles)
+{
+	return (uint32_t)k_cyc_to_ns_floor64(cycles);
+}
+
+static void ping_thread(void *a, void *b, void *c)
+{
+	for(int i = 0; i < WARMUP + ITERATIONS; i++){
+		stamp[CH_PONG] = k_cycle_get_32();
+		cur->signal(CH_PONG);
+		cur->wait(CH_PING);
+		uint32_t now = k_cycle_get_32();
+
+		if(i >= WARMUP){
+			hist_add(&hist[CH_PING], now - stamp[CH_PING]);
+		}
+	}
+}
+
+static void pong_thread(void *a, void *b, void *c)
+{
+	for(int i = 0; i < WARMUP + ITERATIONS; i++){
+		cur->wait(CH_PONG);
+		uint32_t now = k_cycle_get_32();
+
+		if(i >= WARMUP){
+			hist_add(&hist[CH_PONG], now - stamp[CH_PONG]);
+		}
+		stamp[CH_PING] = k_cycle_get_32();
+		cur->signal(CH_PING);
+	}
+}
+
+static void print_row(const char *prim, const char *prios, const char *dir,
+		      const struct hist *h)
+{
+	printk("%-16s %-10s %-10s %8u %8u %8u %8u %8u\n", prim, prios, dir,
+	       cyc_to_ns(h->min), cyc_to_ns(h->sum / MAX(h->count, 1)),
+	       cyc_to_ns(hist_percentile(h, 50)), cyc_to_ns(hist_percentile(h, 99)),
+	       cyc_to_ns(h->max));
+}
+
+static void print_hist(const struct hist *h)
+{
+	for(int i = 0; i < HIST_BUCKETS; i++){
+		if(h->bucket[i] == 0){
+			continue;
+		}
+		printk("    < %8u ns: %u\n", cyc_to_ns(BIT64(i)), h->bucket[i]);
+	}
+}
+
+static void run(const struct prim *p, int ping_prio, int pong_prio)
+{
+	cur = p;
+	p->init();
+	hist_reset(&hist[CH_PONG]);
+	hist_reset(&hist[CH_PING]);
+
+	/*Every primitive latches the signal, the warm-up rounds absorb start-up*/
+	k_thread_create(&pong_data, pong_stack, K_THREAD_STACK_SIZEOF(pong_stack),
+			pong_thread, NULL, NULL, NULL, pong_prio, 0, K_NO_WAIT);
+	k_thread_create(&ping_data, ping_stack, K_THREAD_STACK_SIZEOF(ping_stack),
+			ping_thread, NULL, NULL, NULL, ping_prio, 0, K_NO_WAIT);
+
+	k_thread_join(&ping_data, K_FOREVER);
+	k_thread_join(&pong_data, K_FOREVER);
+}
+
+void latency_bench_run(void)
+{
+	printk("Handoff latency, %u iterations, %u CPU(s), %u cycles/s\n",
+	       ITERATIONS, arch_num_cpus(), sys_clock_hw_cycles_per_sec());
+	printk("%-16s %-10s %-10s %8s %8s %8s %8s %8s\n", "primitive", "prios",
+	       "handoff", "min ns", "avg ns", "p50 ns", "p99 ns", "max ns");
+
+	for(int i = 0; i < ARRAY_SIZE(prims); i++){
+		const struct prim *p = &prims[i];
+
+		if(p->usable != NULL && !p->usable()){
+			printk("%-16s skipped on this configuration\n", p->name);
+			continue;
+		}
+
+		for(int j = 0; j < ARRAY_SIZE(prio_sets); j++){
+			run(p, prio_sets[j].ping, prio_sets[j].pong);
+			print_row(p->name, prio_sets[j].name, "ping->pong", &hist[CH_PONG]);
+			print_row(p->name, prio_sets[j].name, "pong->ping", &hist[CH_PING]);
+			if(IS_ENABLED(CONFIG_APP_BENCH_HISTOGRAM)){
+				print_hist(&hist[CH_PONG]);
+				print_hist(&hist[CH_PING]);
+			}
+		}
+	}
+	printk("Done\n");
+}
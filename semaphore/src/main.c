@@ -5,6 +5,10 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
+#include "bench.h"
+
+#if defined(CONFIG_APP_MODE_DEMO)
+
 /*Shared counter and mutex*/
 static int shared_counter = 0;
 static struct k_mutex counter_mutex;
@@ -52,3 +56,19 @@ int main(void){
 	printk("Ping-Pong with shared counter using mutex\n");
 	return 0;
 }
+
+#elif defined(CONFIG_APP_MODE_LATENCY)
+
+int main(void){
+	latency_bench_run();
+	return 0;
+}
+
+#elif defined(CONFIG_APP_MODE_COUNTER)
+
+int main(void){
+	counter_bench_run();
+	return 0;
+}
+
+#endif
@@ -5,44 +5,47 @@
 #include <zephyr/drivers/gpio.h>
 #include <string.h>
 
+#include "uart_cmd.h"
+#include "uart_line_rx.h"
+#include "uart_tx.h"
+
 #define UART_DEVICE_NODE DT_CHOSEN(zephyr_console)
 static const struct device *uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
 
 #define LED_NODE DT_ALIAS(led0)
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(LED_NODE, gpios);
 
-#define RX_BUF_SIZE 64
-static uint8_t rx_buf[RX_BUF_SIZE];
-static size_t rx_pos = 0;
-
-static void process_command(const char *cmd){
-	if(strcmp(cmd, "LED ON")==0){
+static int cmd_led(size_t argc, char **argv){
+	if(strcmp(argv[1], "ON") == 0){
 		gpio_pin_set_dt(&led, 1);
-		printk("LED turned ON\n");
-	}else if(strcmp(cmd, "LED OFF") == 0){
+		uart_tx_printf("LED turned ON\r\n");
+	}else if(strcmp(argv[1], "OFF") == 0){
 		gpio_pin_set_dt(&led, 0);
-		printk("LED turned OFF\n");
-	}else if(strcmp(cmd, "TOGGLE")==0){
-		gpio_pin_toggle_dt(&led);
-		printk("LED toggled\n");
+		uart_tx_printf("LED turned OFF\r\n");
 	}else{
-		printk("Error command not found\n");
+		return -EINVAL;
 	}
+	return 0;
+}
+
+UART_CMD_DEFINE(led, "LED", 1, 1, cmd_led, "LED ON|OFF");
+
+static int cmd_toggle(size_t argc, char **argv){
+	gpio_pin_toggle_dt(&led);
+	uart_tx_printf("LED toggled\r\n");
+	return 0;
 }
 
-/* Receives from console*/
-static void uart_cb(const struct device *dev, void *user_data){
-	uint8_t c;
-	while(uart_irq_update(dev) && uart_irq_rx_ready(dev)){
-		uart_fifo_read(dev, &c, 1);
-		
-		if(c == '\n' || c == '\r'){
-			rx_buf[rx_pos] = '\0';
-			process_command(rx_buf);
-			rx_pos=0;
-		}else if(rx_pos < RX_BUF_SIZE - 1){
-			rx_buf[rx_pos++] = c;
-		}
+UART_CMD_DEFINE(toggle, "TOGGLE", 0, 0, cmd_toggle, "Toggle the LED");
+
+/* Runs in the line receive thread, not in the UART ISR */
+static void process_command(char *cmd, size_t len){
+	int ret = uart_cmd_dispatch(cmd);
+
+	if(ret == -ENOENT){
+		uart_tx_printf("Error command not found\r\n");
+	}else if(ret == -EINVAL){
+		uart_tx_printf("Error invalid arguments\r\n");
 	}
 }
 
@@ -55,14 +58,19 @@ int main(void)
 	
 	gpio_pin_configure_dt(&led, GPIO_OUTPUT_INACTIVE);
 	
-	/*Welcome message */
-	const char welcome[] = "Send 'LED ON','LED OFF',or 'TOGGLE'\r\n";
-	for(int i = 0; i < strlen(welcome); i++){
-		uart_poll_out(uart_dev, welcome[i]);
+	if(uart_tx_init(uart_dev) < 0){
+		printk("UART transmit init failed\n");
+		return -1;
 	}
+
+	/*Welcome message */
+	const char welcome[] = "Send 'LED ON','LED OFF','TOGGLE' or 'HELP'\r\n";
+	uart_tx_write(welcome, sizeof(welcome) - 1);
 	
-	uart_irq_callback_user_data_set(uart_dev, uart_cb, NULL);
-	uart_irq_rx_enable(uart_dev);
+	if(uart_line_rx_start(uart_dev, process_command) < 0){
+		printk("UART receive start failed\n");
+		return -1;
+	}
 	
 	while(1){
 		k_sleep(K_FOREVER);
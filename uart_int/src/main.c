@@ -5,25 +5,16 @@
 #include <zephyr/drivers/uart.h>
 #include <string.h>
 
+#include "uart_line_rx.h"
+#include "uart_tx.h"
+
 #define UART_DEVICE_NODE DT_CHOSEN(zephyr_console)
-#define RX_BUF_SIZE 64
 
 static const struct device *uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
-static uint8_t rx_buf[RX_BUF_SIZE];
-static size_t rx_pos = 0;
 
-static void uart_cb(const struct device *dev, void *user_data){
-	uint8_t ch;
-	while(uart_irq_update(dev) && uart_irq_rx_ready(dev)){
-		uart_fifo_read(dev, &ch, 1);
-		if(ch == '\n' || ch == '\r') {
-			rx_buf[rx_pos] = '\0';
-			printk("Received: %s\n", rx_buf);
-			rx_pos=0;
-		}else if(rx_pos < RX_BUF_SIZE - 1){
-			rx_buf[rx_pos++]=ch;
-		}
-	}
+/* Runs in the line receive thread, not in the UART ISR */
+static void line_received(char *line, size_t len){
+	uart_tx_printf("Received: %s\r\n", line);
 }
 
 int  main(void){
@@ -31,15 +22,20 @@ int  main(void){
 		printk("UART not ready\n");
 		return -1;
 	}
-	/*Sending welcome using polling */
-	const char welcome[] = "UART interrupt reception\r\n";
-	for(int str_index = 0; str_index < strlen(welcome); str_index++){
-		uart_poll_out(uart_dev, welcome[str_index]);
+	if(uart_tx_init(uart_dev) < 0){
+		printk("UART transmit init failed\n");
+		return -1;
 	}
+
+	/*Sending welcome through the buffered transmit path */
+	const char welcome[] = "UART interrupt reception\r\n";
+	uart_tx_write(welcome, sizeof(welcome) - 1);
 	
-	/*Setup interrupt callback */
-	uart_irq_callback_user_data_set(uart_dev, uart_cb, NULL);
-	uart_irq_rx_enable(uart_dev);
+	/*Start reception, framing and printing happen in thread context */
+	if(uart_line_rx_start(uart_dev, line_received) < 0){
+		printk("UART receive start failed\n");
+		return -1;
+	}
 	while(1){
 		k_sleep(K_FOREVER);
 	}
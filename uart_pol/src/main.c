@@ -1,29 +1,118 @@
-/* UART polling messages welcome on console
+/* UART echo welcome on console, polling or event-driven receive
  * Author: Stuti*/
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/uart.h>
 #include <string.h>
 
+#include "uart_line_rx.h"
+#include "uart_tx.h"
+
 #define UART_DEVICE_NODE DT_CHOSEN(zephyr_console)
 static const struct device *uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
 
-void main(void){
-	if(!device_is_ready(uart_dev)){
-		printk("UART device not ready\n");
-		return;}
-	
-	/*To transmit welcome message */
-	const char welcome[] = "Welcome to UART polling demo!\r\n";
-	for(int i = 0; i < strlen(welcome); i++){
-		uart_poll_out(uart_dev, welcome[i]);
+#define REPORT_MS (CONFIG_APP_ECHO_REPORT_S * MSEC_PER_SEC)
+
+#if defined(CONFIG_APP_ECHO_POLL)
+static uint32_t poll_rx_bytes;
+static uint32_t poll_overruns;
+#endif
+
+/* Idle CPU share and dropped bytes since the previous report */
+static void echo_report(void){
+	static k_thread_runtime_stats_t prev;
+	k_thread_runtime_stats_t now;
+	struct uart_tx_stats tx;
+	uint32_t rx_bytes, rx_dropped;
+
+	if(k_thread_runtime_stats_all_get(&now) != 0){
+		return;
 	}
-	
+
+	uint64_t total = now.execution_cycles - prev.execution_cycles;
+	uint64_t idle = now.idle_cycles - prev.idle_cycles;
+	uint32_t idle_pm = total ? (uint32_t)((idle * 1000U) / total) : 0;
+
+	prev = now;
+
+#if defined(CONFIG_APP_ECHO_EVENT)
+	struct uart_line_rx_stats rx;
+
+	uart_line_rx_stats_get(&rx);
+	rx_bytes = rx.rx_bytes;
+	rx_dropped = rx.dropped_bytes;
+#else
+	/* Polling cannot see lost bytes, only hardware overrun events (>= 1 byte each) */
+	rx_bytes = poll_rx_bytes;
+	rx_dropped = poll_overruns;
+#endif
+	uart_tx_stats_get(&tx);
+
+	uart_tx_printf("[%s] idle %u.%u%% rx %u dropped rx %u tx %u\r\n",
+		       IS_ENABLED(CONFIG_APP_ECHO_EVENT) ? "event" : "poll",
+		       idle_pm / 10U, idle_pm % 10U, rx_bytes, rx_dropped, tx.dropped_bytes);
+}
+
+#if defined(CONFIG_APP_ECHO_EVENT)
+
+/* Runs in the receive thread each time the UART reports data */
+static void echo_burst(const uint8_t *data, size_t len){
+	uart_tx_write(data, len);
+}
+
+static void echo_loop(void){
+	if(uart_line_rx_start_raw(uart_dev, echo_burst) < 0){
+		printk("UART receive start failed\n");
+		return;
+	}
+
+	/* Nothing to do here, the core only wakes up for received data */
+	while(1){
+		if(REPORT_MS == 0){
+			k_sleep(K_FOREVER);
+		}
+		k_msleep(REPORT_MS);
+		echo_report();
+	}
+}
+
+#else /* CONFIG_APP_ECHO_POLL */
+
+static void echo_loop(void){
+	int64_t next_report = k_uptime_get() + REPORT_MS;
 	uint8_t c;
+
 	while(1){
 		if(uart_poll_in(uart_dev, &c) == 0){
-			uart_poll_out(uart_dev, c);
+			poll_rx_bytes++;
+			uart_tx_write(&c, 1);
+		}
+		if(uart_err_check(uart_dev) & UART_ERROR_OVERRUN){
+			poll_overruns++;
+		}
+		if(REPORT_MS != 0 && k_uptime_get() >= next_report){
+			next_report += REPORT_MS;
+			echo_report();
 		}
 		k_msleep(10);
 	}
 }
+
+#endif /* CONFIG_APP_ECHO_EVENT */
+
+void main(void){
+	if(!device_is_ready(uart_dev)){
+		printk("UART device not ready\n");
+		return;}
+	
+	if(uart_tx_init(uart_dev) < 0){
+		printk("UART transmit init failed\n");
+		return;
+	}
+
+	/*To transmit welcome message */
+	const char welcome[] = "Welcome to UART echo demo!\r\n";
+	uart_tx_write(welcome, sizeof(welcome) - 1);
+	
+	echo_loop();
+}